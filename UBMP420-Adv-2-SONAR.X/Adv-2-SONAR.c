@@ -22,6 +22,12 @@
  or H2, and GND connected to either of the H1 or H2 ground pins. The program can
  be configured to work on other header pins -- consult the schematic to check
  which header connections are shared by other components of your UBMP4 build. 
+ 
+ The SONAR functions are located in the SONAR.c file. This program uses the
+ interrupt-driven measurement functions, which time the ECHO pulse using Timer1
+ and the INT pin interrupt on H2, leaving the main loop free for other tasks
+ while each SONAR ping is in flight. The main loop runs the SONAR, display and
+ pushbutton tasks at their own periods using the TASK.c task scheduler.
 ==============================================================================*/
 
 #include    "xc.h"              // Microchip XC8 compiler include file
@@ -29,44 +35,321 @@
 #include    "stdbool.h"         // Include Boolean (true/false) definitions
 
 #include    "UBMP420.h"         // Include UBMP4.2 constants and functions
+#include    "SONAR.h"           // Include SONAR constants and functions
+#include    "RANGE.h"           // Include range processing functions
+#include    "TASK.h"            // Include task scheduler functions
+#include    "SERIAL.h"          // Include serial telemetry functions
+#include    "CDC.h"             // Include USB CDC streaming functions
+#include    "STATS.h"           // Include instrumentation functions
+#include    "TONE.h"            // Include beeper tone functions
+#include    "I2C.h"             // Include I2C slave register map functions
 
 // TODO Set linker ROM ranges to 'default,-0-7FF' under "Memory model" pull-down.
 // TODO Set linker code offset to '800' under "Additional options" pull-down.
 
-// TODO Define SONAR module I/O header pins and modify TRISC for output on TRIG
-
-// SONAR module I/O pin assignment
-#define TRIG    LATCbits.LATC0  // SONAR TRIG(ger) output on H1
-#define ECHO    PORTCbits.RC1   // SONAR ECHO input on H2
+// TODO Define the SONAR module I/O header pins (TRIG_PIN and ECHO_PIN) in
+// SONAR.h. The sonar_config() function sets their TRISC bits automatically.
 
 // Program variable definitions
 unsigned char distance;         // Target distance in cm
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+unsigned char distances[SONAR_SENSORS]; // Filtered range of each module (cm)
+#if RANGE_FILTERS < SONAR_SENSORS
+#error "Set RANGE_FILTERS in RANGE.h to SONAR_SENSORS to filter every SONAR module"
+#endif
+#endif
+int velocity = 0;               // Target velocity in cm/s (- approaching)
 unsigned int timerResult;       // Faux timer result for comparison testing
+unsigned char pingTimer = 0;    // Time until the next SONAR ping (ms)
+unsigned int pingBlocked = 0;   // Ping blocked Timer1 ticks not yet added
+
+// Low-power ping mode definitions. Enable LOW_POWER in CONFIG.h to sleep
+// between pings instead of running the main loop continuously at 48 MHz. Each
+// ping is sent as soon as the processor wakes up, and the processor sleeps
+// again as soon as the range has been read and displayed. Beyond-range ECHO
+// pulses are drained while sleeping, and the INT interrupt on the ECHO falling
+// edge wakes the processor. LOW_POWER_SLEEP (longer than SONAR_RECOVERY_TIME)
+// sets the ping period, and the energy used per measurement. A faulty module's
+// ECHO pulse is abandoned after LOW_POWER_DRAIN_WAKES 32ms drain sleeps. The
+// processor has to stay awake at 48 MHz while an ECHO pulse is timed, since
+// Sleep stops Timer1 (and the PIC16F1459 has no Idle mode), so measurements
+// are limited to LOW_POWER_RANGE to shorten the awake time of each ping from
+// up to about 15ms (SONAR_MAX_RANGE) to under 7ms. The rest of a longer ECHO
+// pulse is drained while sleeping.
+#define LOW_POWER_SLEEP WDT_64MS    // Sleep time between pings (~64ms)
+#define LOW_POWER_DRAIN_WAKES 8     // Maximum ECHO drain wake-ups (32ms each)
+#define LOW_POWER_RANGE 100         // Maximum range of low-power pings (cm)
+
+// LED bar-graph display definitions. LEDs D2-D5 light up in turn as the range
+// increases past each BAR_Dx threshold. The ledBar[] display table is filled
+// at compile time from the thresholds, with one entry per 2^BAR_SHIFT cm of
+// range for ranges up to BAR_STEPS entries, and any longer range displays the
+// last entry. BAR_STEPS << BAR_SHIFT must be greater than BAR_D5.
+#define BAR_D2      1           // Light D2 for ranges greater than 1cm
+#define BAR_D3      5           // Light D3 for ranges greater than 5cm
+#define BAR_D4      10          // Light D4 for ranges greater than 10cm
+#define BAR_D5      20          // Light D5 for ranges greater than 20cm
+#define BAR_SHIFT   0           // Display table range step (2^BAR_SHIFT cm)
+#define BAR_STEPS   32          // Display table entries (8 x BAR4() below)
+#define BAR_LEDS    0b11110000  // LED D2-D5 pins in LATC
 
+// LED bar-graph pattern for range entry n of the display table
+#define BAR(n)      (((n) << BAR_SHIFT) > BAR_D5 ? 0b11110000 : \
+                     ((n) << BAR_SHIFT) > BAR_D4 ? 0b01110000 : \
+                     ((n) << BAR_SHIFT) > BAR_D3 ? 0b00110000 : \
+                     ((n) << BAR_SHIFT) > BAR_D2 ? 0b00010000 : 0)
+#define BAR4(n)     BAR(n), BAR(n + 1), BAR(n + 2), BAR(n + 3)
 
-// SONAR range starter function - return range to the closest target in cm.
-unsigned char sonar_range(void)
+#ifndef MINIMAL
+// LED bar-graph display table (stored in program memory)
+const unsigned char ledBar[BAR_STEPS] = {
+    BAR4(0), BAR4(4), BAR4(8), BAR4(12), BAR4(16), BAR4(20), BAR4(24), BAR4(28)
+};
+
+// Display range as an LED bar-graph on LEDs D2-D5. Using a look-up table takes
+// the same time for every range, and changes only the LED bits in LATC to
+// avoid disturbing SONAR TRIG outputs on the other PORTC pins.
+void display_range(unsigned char range)
 {
-    // Make TRIGger pulse to start a new measurement
-    TRIG = 1;
-    __delay_us(20);
-    TRIG = 0;
-    
-    // Reset range, wait for ECHO pulse to start
-    unsigned char range = 0;
-	while(ECHO == 0);           // ECHO=0 during transmit, ECHO=1 during receive
-    
-    // Count range until ECHO pulse ends
-	do {
-		__delay_us(58);			// Time delay equivalent to ~2cm of sound travel
-		if(range < 255)         // Prevent range from overflowing
+    range = range >> BAR_SHIFT;
+    if(range >= BAR_STEPS)
+    {
+        range = BAR_STEPS - 1;
+    }
+    LATC = (LATC & ~BAR_LEDS) | ledBar[range];
+}
+#endif
+
+// Range band event definitions. Enable RANGE_EVENTS in CONFIG.h to update the
+// LED bar-graph, and send telemetry, only when the range moves into a
+// different bar-graph band (using the range_event() hysteresis in RANGE.c),
+// instead of after every ping. Unchanged range samples cost only the band
+// comparisons.
+
+#ifdef RANGE_EVENTS
+// Range band thresholds (ascending) and the LED bar-graph pattern for each band
+const unsigned char rangeBandLimits[4] = { BAR_D2, BAR_D3, BAR_D4, BAR_D5 };
+const unsigned char bandLeds[5] = {
+    0, 0b00010000, 0b00110000, 0b01110000, 0b11110000
+};
+#endif
+
+// Proximity tone definitions. Enable PROXIMITY_TONE in CONFIG.h to beep the
+// piezo beeper at a rate that increases as the range decreases, like a parking
+// sensor. The TONE.c Timer2 interrupt generates the tone, so the SONAR task
+// only sets the beep period after each ping. The beep period is TONE_MS_PER_CM
+// ms for each cm of range, becoming a continuous tone at close range, and the
+// beeper is silent beyond TONE_RANGE or when there is no valid range.
+#define TONE_MS_PER_CM  10          // Beep period per cm of range (ms)
+#define TONE_RANGE      50          // Maximum beeping range (cm)
+
+// I2C co-processor definitions. Enable I2C_SLAVE in CONFIG.h to let a host
+// microcontroller read the latest range, velocity, status and measurement
+// counters from the I2C.c register map at I2C_ADDRESS (using SDA on RB4 and
+// SCL on RB6, shared with SW2 and SW4). The register map is published after
+// every measurement, and the host can read it at any time.
+
+#ifndef BENCHMARK               // The BENCH.c benchmark program replaces main()
+// Range telemetry. Enable TELEMETRY in CONFIG.h to send each new range sample
+// over the EUSART TX pin (RB7, shared with SW5) as a binary SERIAL.c frame.
+
+// USB range streaming. Enable USB_CDC in CONFIG.h (and add the USB device
+// stack files listed in CDC.h) to also stream each new range sample to a USB
+// host in batched USB CDC packets.
+#define CDC_TASK_PERIOD     1       // Run USB stack and send packets
+#define TEMP_TASK_PERIOD    250     // Update SONAR temperature compensation
+#define STATS_TASK_PERIOD   250     // Send instrumentation counters (STATS)
+
+// Task periods (ms) for the tasks run by the task scheduler
+#define SONAR_TASK_PERIOD   1       // Ping and read SONAR module
+#define DISPLAY_TASK_PERIOD 10      // Update LED bar-graph display
+#define BUTTON_TASK_PERIOD  1       // Check pushbuttons
+
+#ifdef I2C_SLAVE
+// I2C measurement counters
+unsigned int i2cCount = 0;      // Measurements completed
+unsigned int i2cErrors = 0;     // Measurements without a valid range
+
+// Update the I2C register map with the latest measurement, and publish it.
+void i2c_report(void)
+{
+    i2cCount ++;
+    if(sonarStatus != SONAR_OK)
+    {
+        i2cErrors ++;
+    }
+    i2cData[I2C_REG_STATUS] = sonarStatus;
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        i2cData[I2C_REG_RANGE + i] = distances[i];
+    }
+#else
+    i2cData[I2C_REG_RANGE] = distance;
+#endif
+    i2cData[I2C_REG_VELOCITY] = (unsigned char)velocity;
+    i2cData[I2C_REG_VELOCITY + 1] = (unsigned char)((unsigned int)velocity >> 8);
+    i2cData[I2C_REG_COUNT] = (unsigned char)i2cCount;
+    i2cData[I2C_REG_COUNT + 1] = (unsigned char)(i2cCount >> 8);
+    i2cData[I2C_REG_ERRORS] = (unsigned char)i2cErrors;
+    i2cData[I2C_REG_ERRORS + 1] = (unsigned char)(i2cErrors >> 8);
+    i2cData[I2C_REG_TIME] = (unsigned char)taskTime;
+    i2cData[I2C_REG_TIME + 1] = (unsigned char)(taskTime >> 8);
+    i2c_publish();
+}
+#endif
+
+// Range update - filter a new SONAR 1 range sample, track its velocity, and
+// pass the filtered range on to the beeper, range events and data streams.
+void range_update(unsigned char range)
+{
+    unsigned char lastDistance = distance;
+    distance = range_filter(0, range);  // Filter range samples
+    if(distance == 0)
+    {
+        velocity = 0;           // No target
+    }
+    else if(lastDistance == 0)
+    {
+        range_velocity_reset(distance, taskTime);   // New target
+        velocity = 0;
+    }
+    else if(range != 0)
+    {
+        velocity = range_velocity(distance, taskTime);  // Track velocity
+    }
+#ifdef PROXIMITY_TONE
+    if(distance == 0 || distance > TONE_RANGE)
+    {
+        tone_period(TONE_OFF);
+    }
+    else
+    {
+        tone_period((unsigned int)distance * TONE_MS_PER_CM);
+    }
+#endif
+#ifdef RANGE_EVENTS
+    range_event(distance);      // Calls band_event() if the band has changed
+#elif defined(TELEMETRY)
+    serial_frame(0, distance, taskTime);    // Send range in background
+#endif
+#ifdef USB_CDC
+    cdc_sample(0, distance, taskTime);      // Batch range for USB host
+#endif
+}
+
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+// SONAR task - ping each SONAR module in turn (SONAR_SCAN), or ping all of
+// them together no sooner than SONAR_MIN_PERIOD after the previous ping
+// (SONAR_PARALLEL), and filter each module's new ranges separately. SONAR 1
+// also drives the velocity, beeper, range events and data streams.
+void sonar_task(void)
+{
+#ifdef SONAR_SCAN
+    sonar_scan();
+#else
+    if(pingTimer != 0)
+    {
+        pingTimer --;
+    }
+    if(pingTimer == 0)
+    {
+        sonar_range_parallel();
+        pingTimer = SONAR_MIN_PERIOD;
+        
+        // Add back the ticks lost while the ping disabled interrupts. The
+        // latched Timer0 interrupt counts one of them, and the part of a tick
+        // left over is kept for the next ping so the scheduler doesn't drift.
+        pingBlocked += sonarBlockedTicks;
+        unsigned char lost = (unsigned char)(pingBlocked / (SONAR_TMR1_FREQ / 1000));
+        pingBlocked -= lost * (SONAR_TMR1_FREQ / 1000);
+        if(lost > 1)
         {
-            range ++;
+            tick_add(lost - 1);
         }
-	} while(ECHO == 1);         // Repeat until ECHO pulse ends
-    
-	return(range);              // Return target distance in cm
+    }
+#endif
+    unsigned char updated = sonarUpdated;
+    if(updated == 0)
+    {
+        return;
+    }
+    sonarUpdated = 0;
+    if(updated & 1)
+    {
+        range_update(sonarRanges[0]);
+        distances[0] = distance;
+    }
+    for(unsigned char i = 1; i != SONAR_SENSORS; i++)
+    {
+        if(updated & (unsigned char)(1 << i))
+        {
+            distances[i] = range_filter(i, sonarRanges[i]);
+        }
+    }
+#ifdef I2C_SLAVE
+    i2c_report();               // Publish results to the I2C host
+#endif
+}
+#else
+// SONAR task - ping as soon as the SONAR module is ready, but no sooner than
+// SONAR_MIN_PERIOD after the previous ping, and filter each new range.
+void sonar_task(void)
+{
+    if(pingTimer != 0)
+    {
+        pingTimer --;
+    }
+    if(pingTimer == 0 && sonar_ready())
+    {
+        sonar_start();
+        pingTimer = SONAR_MIN_PERIOD;
+    }
+    if(sonarDone)
+    {
+        range_update(sonar_read());
+#ifdef I2C_SLAVE
+        i2c_report();           // Publish results to the I2C host
+#endif
+    }
+}
+#endif
+
+#ifdef RANGE_EVENTS
+// Range band event handler - show the new band on the LED bar-graph, and send
+// the range that caused the band change.
+void band_event(unsigned char band)
+{
+    LATC = (LATC & ~BAR_LEDS) | bandLeds[band];
+#ifdef TELEMETRY
+    serial_frame(SERIAL_BAND_EVENT | band, distance, taskTime);  // Send band change
+#endif
+}
+#endif
+
+#ifndef MINIMAL
+// Display task - show the distance on the LED bar-graph.
+void display_task(void)
+{
+    display_range(distance);
 }
+#endif
+
+// Button task - activate bootloader if SW1 is pressed.
+void button_task(void)
+{
+    if(SW1 == 0)
+    {
+        RESET();
+    }
+}
+
+// Minimal build definitions. The 'Minimal' project configuration defines
+// MINIMAL to build the smallest program that still pings the SONAR module and
+// filters the range (e.g. to measure the footprint of the SONAR core using
+// 'make footprint CONF=Minimal'). The LED bar-graph display is left out, and
+// CONFIG.h leaves every feature (and so the ADC, tone, serial and I2C
+// interrupt handlers in UBMP420.h) off in the Minimal configuration.
 
 int main(void)
 {
@@ -74,61 +357,126 @@ int main(void)
     OSC_config();               // Configure oscillator for 48 MHz
     UBMP4_config();             // Configure I/O for on-board UBMP4 devices
     
-    // Enable output on TRIG pin (match TRISC settings to pin definitions)
-    TRISCbits.TRISC0 = 0;       // Set H1 (TRIG) as output pin (H2 remains input)
+    sonar_config();             // Configure TRIG, Timer1 and ECHO interrupt
+    
+    // Enable the watchdog timer as a backstop. The watchdog resets UBMP4 if
+    // the main loop stops running (and clearing it) for longer than 256ms.
+    WDTCON = WDT_256MS;         // Set WDT period to 256ms, enable WDT (SWDTEN)
     
-    // Distance measurement pseudo-code
-    // timer_config()           // Configure microsecond timer
+    // Distance measurement using the UBMP420.c Timer1 pulse functions (don't
+    // use them together with sonar_config(), since both use Timer1)
+    // timer_config(TIMER_1_5MHZ); // Configure Timer1 for 2/3us ticks
     // sonar_TRIG()             // Start a new measurement by pulsing TRIG pin
-    // timer_clear()            // Reset timer
-    // timer_pulse()            // Measure ECHO pulse length (timerResult = us)
+    // timer_clear();           // Reset timer
+    // timerResult = timer_pulse(); // Measure ECHO pulse length (Timer1 ticks)
+    // distance = sonar_ticks_to_cm(timerResult);    // Convert 2/3us ticks to cm
     timerResult = 1438;         // Arbitrarily chosen pulse length (microseconds)
     
     // Distance calculation and simulator instruction cycles/run-time stopwatch
     // results for three typically found distance measurement solutions. Set the
     // timerResult variable to a sample pulse length and un-comment one or more
-    // of the distance calculations to measure the delay in the simulator.
+    // of the distance calculations to measure the delay in the simulator, or
+    // build the 'Benchmark' project configuration to run the BENCH.c program,
+    // which measures each calculation over a range of timerResult values.
     
     // distance = (timerResult / 2) * 0.0344;  // 1941 cycles/161.75 microseconds, 48 extra data bytes used
     // distance = timerResult / 29 / 2;    // 527 cycles/43.92 microseconds, 6 extra data bytes used
     // distance = timerResult / 58;        // 475 cycles/39.58 microseconds, 6 extra data bytes used
+    // distance = sonar_us_to_cm(timerResult);  // Reciprocal shift-and-add, no division (see SONAR.c)
     
+#ifdef LOW_POWER
+    sonar_max_range(LOW_POWER_RANGE);   // Limit the awake time of each ping
     while(1)
     {
-        // Get distance from SONAR module
-        distance = sonar_range();   
+        CLRWDT();               // Clear watchdog timer every main loop cycle
         
-        // Display distance on LEDs
-        if(distance > 20)
-        {
-            LATC = 0b11110000;
-        }
-        else if(distance > 10)
-        {
-            LATC = 0b01110000;
-        }
-        else if(distance > 5)
-        {
-            LATC = 0b00110000;
-        }
-        else if (distance > 1)
-        {
-            LATC = 0b00010000;
-        }
-        else
+        // Ping, and wait awake for the measurement to finish (Timer1 stops in
+        // Sleep). The module has recovered from the last ping while asleep.
+        sonar_start();
+        while(sonarBusy && !sonarDone)
+            ;
+        
+        // Get distance from SONAR module and display it on LEDs
+        if(sonarDone)
         {
-            LATC = 0;
+            distance = range_filter(0, sonar_read());   // Filter range samples
         }
+#ifndef MINIMAL
+        display_range(distance);
+#endif
         
-        __delay_ms(100);        // Do ~10 SONAR pings per second
-                
         // Activate bootloader if SW1 is pressed.
         if(SW1 == 0)
         {
             RESET();
         }
+        
+        // Sleep until any beyond-range ECHO pulse ends (the falling edge INT
+        // interrupt wakes the processor), then until the next ping is due. An
+        // ECHO pulse that is still active after LOW_POWER_DRAIN_WAKES wake-ups
+        // is abandoned, and SW1 is checked after every wake-up.
+        unsigned char wakes = LOW_POWER_DRAIN_WAKES;
+        while(sonarBusy)
+        {
+            if(SW1 == 0)
+            {
+                RESET();
+            }
+            if(wakes == 0)      // ECHO stuck high - abandon the measurement
+            {
+                sonar_cancel();
+                break;
+            }
+            wakes --;
+            sleep_wdt(WDT_32MS);
+        }
+        sleep_wdt(LOW_POWER_SLEEP);
     }
+#else
+    // Run each part of the program as a task at its own period. Each task does
+    // a small amount of work and returns, so SW1 is checked every 1ms.
+    tick_config();              // Start 1ms Timer0 tick
+#ifdef TELEMETRY
+    serial_config();            // Configure EUSART for range telemetry
+#endif
+#if defined(STATS) && defined(TELEMETRY)
+    task_add(stats_send, STATS_TASK_PERIOD);
+#endif
+#ifdef I2C_SLAVE
+    i2c_config();               // Start I2C slave register map
+#endif
+#ifdef PROXIMITY_TONE
+    tone_config();              // Start Timer2 tone generator (silent)
+#endif
+#ifdef SONAR_TEMP_COMP
+    sonar_temp_config();        // Configure ADC for temperature indicator
+    sonar_temp_update();
+    task_add(sonar_temp_update, TEMP_TASK_PERIOD);
+#endif
+#ifdef USB_CDC
+    cdc_config();               // Attach to USB host for range streaming
+    task_add(cdc_task, CDC_TASK_PERIOD);
+#endif
+    task_add(sonar_task, SONAR_TASK_PERIOD);
+#ifdef RANGE_EVENTS
+    range_event_config(rangeBandLimits, sizeof(rangeBandLimits), band_event);
+#elif !defined(MINIMAL)
+    task_add(display_task, DISPLAY_TASK_PERIOD);
+#endif
+    task_add(button_task, BUTTON_TASK_PERIOD);
+    
+    while(1)
+    {
+        STATS_LOOP_START();     // Measure main loop time (STATS builds only)
+        CLRWDT();               // Clear watchdog timer every main loop cycle
+        task_run();             // Run any tasks that are due
+        
+        // Other processing can be done here while the SONAR ping is in flight
+        STATS_LOOP_END();
+    }
+#endif
 }
+#endif
 
 /* Learn More -- Program Analysis Activities
  * 
@@ -198,18 +546,21 @@ int main(void)
  *      a round-trip time of 58us (1cm to the target, and 1cm back), so using
  *      58us as the timer value lets the program count centimetres directly
  *      instead of counting microseconds first. To measure in inches, substitute
- *      148us as the timer unit instead. Each timer count can now represent one
- *      distance unit, and the program can simply count loops of the unit-length
- *      delays to determine the distance. When the pulse ends, the loop counter
- *      already contains the distance, and no additional calculations are
- *      required. Not only is the time taken by calculations freed up, this
- *      method also uses less data memory as no additional memory registers are
- *      required during the calculations to maintain precision or match the data
- *      formats of the numbers during the execution of the math algorithms.
+ *      148us as the timer unit instead (SONAR.h lets you choose between cm,
+ *      half-cm, 2mm and inch range functions, and calculates the delay for each
+ *      unit when the program is compiled). Each timer count can now represent
+ *      one distance unit, and the program can simply count loops of the
+ *      unit-length delays to determine the distance. When the pulse ends, the
+ *      loop counter already contains the distance, and no additional
+ *      calculations are required. Not only is the time taken by calculations
+ *      freed up, this method also uses less data memory as no additional memory
+ *      registers are required during the calculations to maintain precision or
+ *      match the data formats of the numbers during the execution of the math
+ *      algorithms.
  * 
  *      The simplified, no-math distance measurement code can be seen in the
- *      the main loop of the sonar_range() function, where it counts distance-
- *      related units of time instead of microseconds:
+ *      the main loop of the sonar_range() function (in SONAR.c), where it
+ *      counts distance-related units of time instead of microseconds:
 
     // Count range until ECHO pulse ends
 	do {
@@ -299,6 +650,11 @@ int main(void)
       .
       .
 
+ *      (The interrupt-driven SONAR functions in SONAR.c avoid both kinds of
+ *      waiting: once a measurement passes the range set by sonar_max_range(),
+ *      the result is ready immediately, and the ECHO interrupt waits for the
+ *      rest of the ECHO pulse to end in the background.)
+ *
  *      So, if the SONAR module cannot be re-triggered until the ECHO pulse
  *      ends, was this entire idea of exiting the pulse measurement early 
  *      totally pointless? Not really, as longer distance range measurements
@@ -321,6 +677,10 @@ bool sonar_ready(void)
     return(true);               // SONAR ready
 }
 
+ *      (The sonar_ready() function in SONAR.c also checks that a short
+ *      recovery time has passed since the end of the last ECHO pulse, which
+ *      is timed by Timer1, and main() uses it to ping as often as possible.)
+ *
  *      With this simple new function, the main code can do a quick call to
  *      determine if the SONAR module is ready, and get a new measurement if it
  *      is, or continue with other work if it's not. Let's put all of these
@@ -369,4 +729,17 @@ unsigned char sonar_range(unsigned char maxRange)
  *      make use of a do-while loop structure instead of a typical while loop.
  *      What is the big difference between a while loop and a do-while loop?
  *      Why do you think a do-while loop was used here?     
+ * 
+ * 6.   What happens to the original sonar_range() function when the SONAR
+ *      module is unplugged? The while(ECHO == 0) loop waits forever for an
+ *      ECHO pulse that will never come, and the program stops responding --
+ *      it can't even check SW1 to start the bootloader! Loops that wait for
+ *      external signals should always have a way out. The sonar_range()
+ *      function in SONAR.c counts the passes through its ECHO waiting loop
+ *      and gives up after SONAR_START_TIMEOUT microseconds, and stops
+ *      counting when the range reaches SONAR_MAX_RANGE. This makes its
+ *      worst-case run-time predictable, and the sonarStatus variable reports
+ *      the reason for a failed measurement. As a final safety net, this
+ *      program also enables the watchdog timer (WDT). What would happen if
+ *      the CLRWDT() instruction was removed from the main loop?
  */
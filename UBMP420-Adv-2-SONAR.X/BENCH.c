@@ -0,0 +1,196 @@
+/*==============================================================================
+ File: BENCH.c
+ Date: October 14, 2026
+
+ SONAR distance calculation benchmark program
+
+ Measures the number of instruction cycles used by each of the distance
+ calculations compared in the Adv-2-SONAR.c main() function over a sweep of
+ timerResult values, using Timer1 clocked at FOSC/4 (one Timer1 count is one
+ instruction cycle). The sonar_range_cm() counting kernel is measured by
+ driving the ECHO pin (H2) as an output and timing kernel runs that count to
+ two different maximum ranges, and is reported as the number of instruction
+ cycles in each counted cm (696 cycles, or 58us, per cm). The kernel's ECHO
+ start wait loop is timed the same way with ECHO held low, and is reported as
+ the number of cycles in 256 wait passes (256 * SONAR_WAIT_CYCLES + 2 = 1282).
+ Disconnect the SONAR module's ECHO output from H2 while running this program.
+
+ Build the 'Benchmark' project configuration (which defines BENCHMARK) to
+ replace the main program with this benchmark program. The results are saved
+ in the benchMin[], benchMax[] and benchMean[] arrays, which can be inspected
+ in the debugger or simulator Watch window, and LEDs D2-D5 light up as each
+ of the first four benchmarks finishes. D1 lights up when the last benchmark
+ (the division-free sonar_us_to_cm() conversion) finishes.
+==============================================================================*/
+
+#include    "xc.h"              // Microchip XC8 compiler include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constants and functions
+#include    "SONAR.h"           // Include SONAR constants and functions
+
+#ifdef BENCHMARK
+
+// Benchmark definitions
+#define BENCH_FLOAT     0       // (timerResult / 2) * 0.0344 benchmark
+#define BENCH_DIV29     1       // timerResult / 29 / 2 benchmark
+#define BENCH_DIV58     2       // timerResult / 58 benchmark
+#define BENCH_LOOP      3       // sonar_range_cm() kernel cycles per cm benchmark
+#define BENCH_RECIP     4       // sonar_us_to_cm(timerResult) benchmark
+#define BENCH_WAIT      5       // Kernel cycles per 256 ECHO wait passes benchmark
+#define BENCH_TESTS     6       // Number of benchmarks
+
+#define BENCH_FIRST     58      // First timerResult value (1cm)
+#define BENCH_STEP      232     // timerResult step (4cm)
+#define BENCH_SAMPLES   64      // Number of timerResult values (1-253cm)
+#define BENCH_PINGS     32      // Number of kernel measurements
+#define BENCH_RANGE_LONG    255 // Kernel maximum ranges (cm) of counting runs
+#define BENCH_RANGE_SHORT   55
+#define BENCH_WAIT_LONG     SONAR_START_LOOPS   // Kernel wait passes of wait runs
+#define BENCH_WAIT_SHORT    (SONAR_START_LOOPS - 2560)
+
+// Start and stop the Timer1 instruction cycle counter
+#define BENCH_START()   TMR1H = 0; TMR1L = 0; TMR1ON = 1
+#define BENCH_STOP()    TMR1ON = 0
+
+// Benchmark results (instruction cycles)
+unsigned int benchMin[BENCH_TESTS];     // Minimum cycles of each benchmark
+unsigned int benchMax[BENCH_TESTS];     // Maximum cycles of each benchmark
+unsigned int benchMean[BENCH_TESTS];    // Mean cycles of each benchmark
+
+// Benchmark program variables
+unsigned int timerResult;       // Simulated ECHO pulse length (microseconds)
+volatile unsigned char benchDistance;   // Calculated distance (cm)
+unsigned int benchOverhead;     // Cycles used by BENCH_START() and BENCH_STOP()
+unsigned long benchSum;         // Sum of measured cycles
+unsigned char benchCount;       // Number of measurements
+
+// Clear the measurement statistics before starting a new benchmark.
+void bench_clear(unsigned char test)
+{
+    benchMin[test] = 0xFFFF;
+    benchMax[test] = 0;
+    benchSum = 0;
+    benchCount = 0;
+}
+
+// Add one measurement (in cycles) to the benchmark statistics.
+void bench_add(unsigned char test, unsigned int cycles)
+{
+    if(cycles < benchMin[test])
+    {
+        benchMin[test] = cycles;
+    }
+    if(cycles > benchMax[test])
+    {
+        benchMax[test] = cycles;
+    }
+    benchSum += cycles;
+    benchCount ++;
+    benchMean[test] = (unsigned int)(benchSum / benchCount);
+}
+
+// Measure the cycles used by a distance calculation for every timerResult.
+#define BENCH_RUN(test, calculation)                                        \
+    bench_clear(test);                                                      \
+    timerResult = BENCH_FIRST;                                              \
+    for(unsigned char i = 0; i != BENCH_SAMPLES; i++)                       \
+    {                                                                       \
+        BENCH_START();                                                      \
+        calculation;                                                        \
+        BENCH_STOP();                                                       \
+        bench_add(test, TMR1 - benchOverhead);                              \
+        timerResult += BENCH_STEP;                                          \
+    }
+
+// Kernel parameters of sonar_range_cm() at the default speed of sound
+const unsigned char benchParams[SONAR_PARAMS_SIZE] = SONAR_UNIT_PARAMS(SONAR_CM_TIME);
+
+// Time one counting kernel run with ECHO held at the echo level, counting up
+// to maxRange or for up to waitPasses ECHO start wait loop passes. Returns the
+// elapsed Timer1 count (T1CON sets the prescaler).
+unsigned int bench_kernel(bool echo, unsigned char maxRange, unsigned int waitPasses)
+{
+    for(unsigned char i = 0; i != SONAR_PARAMS_SIZE - 1; i++)
+    {
+        sonarKernel[SONAR_K_BLANK + i] = benchParams[i];
+    }
+    sonarKernel[SONAR_K_RANGE] = benchParams[SONAR_PARAMS_SIZE - 1];
+    sonarKernel[SONAR_K_WAIT] = (unsigned char)waitPasses;
+    sonarKernel[SONAR_K_WAIT + 1] = (unsigned char)((waitPasses - 1) >> 8) + 1;
+    sonarKernel[SONAR_K_MAX] = maxRange;
+    PIN_LAT(ECHO_PIN) = echo;
+    BENCH_START();
+    sonar_kernel();
+    BENCH_STOP();
+    return(TMR1);
+}
+
+// Measure the cycles per cm counted by the sonar_range_cm() kernel, and the
+// cycles per 256 ECHO start wait passes. The difference between two runs
+// cancels out the kernel's fixed overhead, leaving only the counting passes
+// (200cm, using the 1:8 prescaler) or the wait passes (2560, using 1:1).
+void bench_loop(void)
+{
+    unsigned int cycles;
+    
+    LATC = LATC & ~SONAR_TRIG_PINS;     // Keep TRIG low
+    TRISC = TRISC & ~SONAR_TRIG_PINS;
+    PIN_TRIS(ECHO_PIN) = 0;     // Drive ECHO (module ECHO must be disconnected)
+    bench_clear(BENCH_LOOP);
+    T1CON = 0b00110000;         // Timer1 off, FOSC/4 clock, 1:8 prescaler
+    for(unsigned char i = 0; i != BENCH_PINGS; i++)
+    {
+        cycles = bench_kernel(1, BENCH_RANGE_LONG, BENCH_WAIT_LONG) -
+            bench_kernel(1, BENCH_RANGE_SHORT, BENCH_WAIT_LONG);
+        bench_add(BENCH_LOOP, (unsigned int)(((unsigned long)cycles * 8 +
+            (BENCH_RANGE_LONG - BENCH_RANGE_SHORT) / 2) / (BENCH_RANGE_LONG - BENCH_RANGE_SHORT)));
+    }
+    bench_clear(BENCH_WAIT);
+    T1CON = 0b00000000;         // Timer1 off, FOSC/4 clock, 1:1 prescaler
+    for(unsigned char i = 0; i != BENCH_PINGS; i++)
+    {
+        cycles = bench_kernel(0, BENCH_RANGE_LONG, BENCH_WAIT_LONG) -
+            bench_kernel(0, BENCH_RANGE_LONG, BENCH_WAIT_SHORT);
+        bench_add(BENCH_WAIT, cycles / ((BENCH_WAIT_LONG - BENCH_WAIT_SHORT) / 256));
+    }
+    PIN_LAT(ECHO_PIN) = 0;
+    PIN_TRIS(ECHO_PIN) = 1;     // Restore ECHO input
+}
+
+int main(void)
+{
+    OSC_config();               // Configure oscillator for 48 MHz
+    UBMP4_config();             // Configure I/O for on-board UBMP4 devices
+    
+    // Count instruction cycles using Timer1, and measure counter overhead
+    T1CON = 0b00000000;         // Timer1 off, FOSC/4 clock, 1:1 prescaler
+    T1GCON = 0b00000000;        // Disable Timer1 gate (count continuously)
+    BENCH_START();
+    BENCH_STOP();
+    benchOverhead = TMR1;
+    
+    // Run each of the distance calculation benchmarks
+    BENCH_RUN(BENCH_FLOAT, benchDistance = (timerResult / 2) * 0.0344);
+    LED2 = 1;
+    BENCH_RUN(BENCH_DIV29, benchDistance = timerResult / 29 / 2);
+    LED3 = 1;
+    BENCH_RUN(BENCH_DIV58, benchDistance = timerResult / 58);
+    LED4 = 1;
+    bench_loop();
+    LED5 = 1;
+    BENCH_RUN(BENCH_RECIP, benchDistance = sonar_us_to_cm(timerResult));
+    D1 = 0;                     // Light D1 (active-low) when all benchmarks finish
+    
+    while(1)
+    {
+        // Activate bootloader if SW1 is pressed.
+        if(SW1 == 0)
+        {
+            RESET();
+        }
+    }
+}
+
+#endif
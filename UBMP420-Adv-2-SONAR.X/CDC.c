@@ -0,0 +1,114 @@
+/*==============================================================================
+ File: CDC.c
+ Date: October 14, 2026
+
+ USB CDC range streaming functions
+
+ Streams SONAR range samples to a USB host through a USB CDC (virtual serial
+ port) interface. Samples are batched into full 64-byte packets in one packet
+ buffer while the other buffer is being sent, so that each USB transfer
+ carries many samples. The USB device stack itself is not part of this
+ project -- see CDC.h. Include the CDC.h file in your main program to call
+ these functions.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "CDC.h"             // Include USB CDC streaming definitions
+
+#ifdef USB_CDC
+
+// Double-buffered packets. Samples are added to cdcPacket[cdcFill] while the
+// other packet is queued or being sent by the USB stack.
+unsigned char cdcPacket[2][CDC_PACKET_SIZE];    // Packet buffers
+unsigned char cdcFill = 0;      // Packet buffer being filled
+unsigned char cdcIndex;         // Next byte in the packet being filled
+unsigned char cdcCount = 0;     // Samples in the packet being filled
+unsigned char cdcAge = 0;       // Time since first sample was added (ms)
+unsigned int cdcTime;           // Time of the last sample added (ms)
+bool cdcQueued = false;         // Other packet buffer is waiting to be sent
+bool cdcSending = false;        // Other packet buffer is being sent
+unsigned char cdcLength;        // Length of the queued packet (bytes)
+unsigned char cdcDropped = 0;   // Samples dropped while buffers were full
+
+// Initialize the USB device stack and attach to the USB bus.
+void cdc_config(void)
+{
+    CDC_USB_INIT();
+}
+
+// Add a range sample to the packet being filled - returns false if it's full.
+bool cdc_sample(unsigned char id, unsigned char range, unsigned int time)
+{
+    unsigned char *packet = cdcPacket[cdcFill];
+    unsigned int delta;
+    
+    if(cdcCount == CDC_SAMPLES) // Both packets full - host not reading
+    {
+        cdcDropped ++;
+        return(false);
+    }
+    if(cdcCount == 0)           // Start a new packet
+    {
+        packet[0] = CDC_SYNC;
+        packet[2] = (unsigned char)time;
+        packet[3] = (unsigned char)(time >> 8);
+        cdcIndex = CDC_HEADER_SIZE;
+        cdcAge = 0;
+        cdcTime = time;
+    }
+    delta = time - cdcTime;
+    if(delta > 255)
+    {
+        delta = 255;
+    }
+    packet[cdcIndex] = id;
+    packet[cdcIndex + 1] = range;
+    packet[cdcIndex + 2] = (unsigned char)delta;
+    cdcIndex += CDC_SAMPLE_SIZE;
+    cdcCount ++;
+    packet[1] = cdcCount;
+    cdcTime = time;
+    return(true);
+}
+
+// Run the USB stack, and queue the packet being filled once it is full (or old
+// enough) so that filling can continue in the other packet buffer.
+void cdc_task(void)
+{
+    CDC_USB_TASKS();
+    if(!CDC_USB_ONLINE())
+    {
+        return;
+    }
+    
+    if(cdcSending && CDC_TX_READY())    // Previous packet finished sending
+    {
+        cdcSending = false;
+        cdcQueued = false;
+    }
+    
+    if(cdcCount != 0)
+    {
+        cdcAge ++;
+        if(!cdcQueued && (cdcCount == CDC_SAMPLES || cdcAge >= CDC_FLUSH_TIME))
+        {
+            cdcLength = cdcIndex;   // Queue this packet and fill the other one
+            cdcQueued = true;
+            cdcFill = cdcFill ^ 1;
+            cdcCount = 0;
+        }
+    }
+    
+    if(cdcQueued && !cdcSending && CDC_TX_READY())
+    {
+        CDC_TX(cdcPacket[cdcFill ^ 1], cdcLength);
+        cdcSending = true;
+    }
+    CDC_TX_SERVICE();
+}
+
+#endif
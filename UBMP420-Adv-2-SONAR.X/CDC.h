@@ -0,0 +1,77 @@
+/*==============================================================================
+ File: CDC.h
+ Date: October 14, 2026
+
+ USB CDC range streaming symbolic constant and function definitions.
+
+ USB stack definitions section:
+ Hooks connecting the CDC.c packet batching functions to the USB device stack.
+
+ Packet definitions section:
+ Layout of the batched range sample packets sent by cdc_task().
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the CDC.c file.
+==============================================================================*/
+
+// USB stack definitions. The CDC.c functions batch range samples into packets
+// and hand each packet to a USB CDC device stack to send. Enable USB_CDC in
+// CONFIG.h and add the Microchip MLA USB device stack and CDC class files
+// (usb_device.c, usb_device_cdc.c, and an application usb_descriptors.c and
+// usb_config.h configured for polled USB and one CDC interface) to the project
+// to use them. The hooks below are the only stack
+// functions used, so a different stack can be used by changing them.
+#ifdef USB_CDC
+#include    "usb.h"             // MLA USB device stack
+#include    "usb_device_cdc.h"  // MLA USB CDC class functions
+
+#define CDC_USB_INIT()      USBDeviceInit(); USBDeviceAttach()
+#define CDC_USB_TASKS()     USBDeviceTasks()
+#define CDC_USB_ONLINE()    (USBGetDeviceState() == CONFIGURED_STATE && !USBIsDeviceSuspended())
+#define CDC_TX_READY()      USBUSARTIsTxTrfReady()
+#define CDC_TX(data, length) putUSBUSART((uint8_t *)(data), (length))
+#define CDC_TX_SERVICE()    CDCTxService()
+#endif
+
+// Packet definitions. Each packet starts with a CDC_HEADER_SIZE byte header:
+// CDC_SYNC, the number of samples in the packet, and the 16-bit timestamp (ms,
+// low byte first) of the first sample. Each sample is CDC_SAMPLE_SIZE bytes:
+// sensor id, range (cm), and the time since the previous sample (ms, 255 max).
+// Filling each 64-byte full-speed packet with 20 samples keeps the overhead to
+// about 3 bytes per sample. Partly filled packets are sent after CDC_FLUSH_TIME.
+#define CDC_SYNC            0xA5        // Packet start byte
+#define CDC_PACKET_SIZE     64          // Full-speed bulk packet size (bytes)
+#define CDC_HEADER_SIZE     4           // Packet header length (bytes)
+#define CDC_SAMPLE_SIZE     3           // Sample length (bytes)
+#define CDC_SAMPLES ((CDC_PACKET_SIZE - CDC_HEADER_SIZE) / CDC_SAMPLE_SIZE)
+#define CDC_FLUSH_TIME      100         // Maximum sample wait time (ms)
+
+extern unsigned char cdcDropped;        // Samples dropped while buffers were full
+
+// Prototypes for CDC.c functions:
+
+/**
+ * Function: void cdc_config(void)
+ *
+ * Initialize the USB device stack and attach to the USB bus.
+ */
+void cdc_config(void);
+
+/**
+ * Function: bool cdc_sample(unsigned char id, unsigned char range, unsigned int time)
+ *
+ * Add a range sample to the packet being filled, and return immediately.
+ * Returns false (and increments cdcDropped) if both packet buffers are full.
+ *
+ * Example usage: cdc_sample(0, distance, taskTime);
+ */
+bool cdc_sample(unsigned char, unsigned char, unsigned int);
+
+/**
+ * Function: void cdc_task(void)
+ *
+ * Run the USB device stack and send each batched packet. Call every 1ms.
+ *
+ * Example usage: task_add(cdc_task, 1);
+ */
+void cdc_task(void);
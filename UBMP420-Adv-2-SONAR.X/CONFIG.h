@@ -0,0 +1,55 @@
+/*==============================================================================
+ File: CONFIG.h
+ Date: October 14, 2026
+
+ Program feature switches
+
+ Feature switches shared by the main program and the library modules. Every
+ source file includes this file through UBMP420.h, so the interrupt handler
+ definitions in UBMP420.h and the bodies of the TONE.c, SERIAL.c, I2C.c, CDC.c
+ and ADC burst functions are only compiled and linked when their feature is
+ enabled here. Un-comment a switch to enable its feature, or define it in the
+ project configuration's compiler macros (e.g. the 'Instrumented'
+ configuration defines STATS and TELEMETRY). Project configurations that
+ replace the main program (BENCHMARK) or build only the SONAR core (MINIMAL)
+ leave every feature off.
+==============================================================================*/
+
+#if !defined(BENCHMARK) && !defined(MINIMAL)
+
+// Low-power ping mode. Un-comment LOW_POWER to sleep between pings instead of
+// running the main loop continuously at 48 MHz (see Adv-2-SONAR.c).
+// #define LOW_POWER                // Sleep between pings
+
+// Range band events. Un-comment RANGE_EVENTS to update the LED bar-graph, and
+// send telemetry, only when the range moves into a different bar-graph band.
+// #define RANGE_EVENTS             // Output range band changes only
+
+// Proximity tone. Un-comment PROXIMITY_TONE to beep the piezo beeper using
+// the TONE.c Timer2 interrupt at a rate that increases as the range decreases.
+// #define PROXIMITY_TONE           // Beep faster as range decreases
+
+// I2C co-processor. Un-comment I2C_SLAVE to serve the latest SONAR results
+// from the I2C.c register map using the MSSP interrupt (not with the
+// SONAR_PARALLEL ranging in SONAR.h, which holds interrupts off while ranging).
+// #define I2C_SLAVE                // Serve SONAR results to an I2C host
+
+// Range telemetry. Un-comment TELEMETRY to send each new range sample over
+// the EUSART TX pin (RB7, shared with SW5) using the SERIAL.c TX interrupt.
+// #define TELEMETRY                // Stream range samples to serial port
+
+// USB range streaming. Un-comment USB_CDC to also stream each new range sample
+// to a USB host in batched USB CDC packets (add the USB device stack files
+// listed in CDC.h to the project first).
+// #define USB_CDC                  // Stream range samples to USB host
+
+// ADC bursts. Un-comment ADC_BURST to enable the interrupt-driven
+// ADC_burst_start() functions and their ADC interrupt handler.
+// #define ADC_BURST                // Interrupt-driven ADC bursts
+
+#endif
+
+// SONAR_TEMP_COMP is switched in SONAR.h, which checks it against MINIMAL.
+#if defined(MINIMAL) && (defined(TELEMETRY) || defined(PROXIMITY_TONE) || defined(RANGE_EVENTS) || defined(I2C_SLAVE) || defined(ADC_BURST) || defined(USB_CDC))
+#error "The MINIMAL build has no display, ADC, tone, serial, USB or I2C interrupt code"
+#endif
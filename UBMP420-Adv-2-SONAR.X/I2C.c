@@ -0,0 +1,108 @@
+/*==============================================================================
+ File: I2C.c
+ Date: October 14, 2026
+
+ I2C slave register map functions
+
+ The MSSP I2C slave lets a host microcontroller read the latest SONAR results
+ from a register map at any time, using UBMP4 as a SONAR co-processor. The
+ program updates the i2cData[] register map and calls i2c_publish() after each
+ measurement, and i2c_isr() answers the host entirely from the interrupt, so
+ the host never has to wait for (or start) a measurement, and the measurement
+ never has to wait for the host. The register map is double-buffered: the
+ host reads one buffer while i2c_publish() fills the other, and the buffers
+ are swapped only at the start of a host read. Include the I2C.h file in your
+ main program to call these functions, and enable I2C_SLAVE in CONFIG.h to
+ compile them.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "I2C.h"             // Include I2C slave definitions
+
+#ifdef I2C_SLAVE
+
+// I2C register map variables
+unsigned char i2cData[I2C_REGS];    // Register map (updated by the program)
+unsigned char i2cRegs[2][I2C_REGS]; // Register map snapshots (host reads one)
+volatile unsigned char i2cFront = 0;    // Snapshot being read by the host
+volatile bool i2cSwap = false;  // New snapshot ready in the other buffer
+unsigned char i2cPointer = 0;   // Next register to send (set by the host)
+bool i2cPointerNext = false;    // Next byte written by the host is the pointer
+
+// Configure the MSSP for I2C slave operation.
+void i2c_config(void)
+{
+    WPUB = WPUB & 0b10101111;   // Disable SW2 (SDA) and SW4 (SCL) pull-ups
+    TRISB = TRISB | 0b01010000; // Set SDA (RB4) and SCL (RB6) as inputs
+    SSP1ADD = I2C_ADDRESS << 1; // Set slave address (bits 7-1)
+    SSP1MSK = 0b11111110;       // Compare all address bits
+    SSP1STAT = 0b10000000;      // Slew rate control off (100kHz)
+    SSP1CON3 = 0b00000000;      // No start/stop interrupts, no address hold
+    SSP1CON2 = 0b00000001;      // Stretch SCL clock after each byte (SEN)
+    SSP1CON1 = 0b00110110;      // Enable MSSP, release SCL, 7-bit I2C slave
+    SSP1IF = 0;
+    SSP1IE = 1;                 // Enable MSSP interrupt
+}
+
+// Publish the register map - clearing i2cSwap first stops i2c_isr() from
+// swapping to the other buffer while it is being filled, so the host always
+// reads a complete snapshot.
+void i2c_publish(void)
+{
+    i2cSwap = false;
+    unsigned char back = i2cFront ^ 1;
+    for(unsigned char i = 0; i != I2C_REGS; i++)
+    {
+        i2cRegs[back][i] = i2cData[i];
+    }
+    i2cSwap = true;             // Swap buffers at the start of the next read
+}
+
+// I2C slave interrupt handler - save the register pointer written by the host,
+// or send the next register to the host, then release the SCL clock.
+void i2c_isr(void)
+{
+    unsigned char data;
+    if(SSPOV)                   // Byte received before last byte was read
+    {
+        SSPOV = 0;
+    }
+    if(R_nW)                    // Host reading
+    {
+        if(!D_nA)               // Address byte starts a new read
+        {
+            data = SSP1BUF;     // Read address to clear BF
+            if(i2cSwap)         // Switch to the new snapshot
+            {
+                i2cFront = i2cFront ^ 1;
+                i2cSwap = false;
+            }
+        }
+        else if(ACKSTAT)        // Host sent NACK - read finished
+        {
+            return;
+        }
+        SSP1BUF = (i2cPointer < I2C_REGS) ? i2cRegs[i2cFront][i2cPointer] : 0;
+        i2cPointer ++;
+    }
+    else                        // Host writing
+    {
+        data = SSP1BUF;         // Read byte to clear BF
+        if(!D_nA)               // Address byte - register pointer comes next
+        {
+            i2cPointerNext = true;
+        }
+        else if(i2cPointerNext) // Register pointer (registers are read-only)
+        {
+            i2cPointer = data;
+            i2cPointerNext = false;
+        }
+    }
+    CKP = 1;                    // Release SCL clock
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*==============================================================================
+ File: I2C.h
+ Date: October 14, 2026
+
+ I2C slave register map symbolic constant and function definitions.
+
+ I2C slave definitions section:
+ MSSP I2C slave address and pins.
+
+ Register map definitions section:
+ Layout of the registers that the I2C host can read.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the I2C.c file.
+==============================================================================*/
+
+// I2C slave definitions. The MSSP uses SDA on RB4 and SCL on RB6, which are
+// shared with pushbuttons SW2 and SW4, so SW2 and SW4 can't be used while the
+// I2C slave is enabled. Connect SDA, SCL and ground to the host's I2C bus,
+// which must have its own pull-up resistors (the weak pull-ups are disabled).
+// The MSSP stretches the SCL clock after each byte until i2c_isr() has
+// handled it, so the host waits for the interrupt instead of losing data.
+#define I2C_ADDRESS     0x42        // 7-bit I2C slave address
+
+// Register map definitions. The host writes a register number, and then reads
+// one or more registers starting from that register (registers past the end of
+// the map read as 0). 16-bit registers are stored low byte first. The host
+// reads from a snapshot of the register map that can't change during the read,
+// so multi-byte values are always consistent.
+#define I2C_REG_STATUS      0       // Last SONAR measurement status (sonarStatus)
+#define I2C_REG_RANGE       1       // Filtered range of SONAR 1-4 (cm, 4 regs)
+#define I2C_REG_VELOCITY    5       // Velocity of SONAR 1 (cm/s, signed 16-bit)
+#define I2C_REG_COUNT       7       // Measurement count (16-bit)
+#define I2C_REG_ERRORS      9       // Failed measurement count (16-bit)
+#define I2C_REG_TIME        11      // Time of last measurement (ms, 16-bit)
+#define I2C_REGS            13      // Number of registers
+
+extern unsigned char i2cData[I2C_REGS]; // Register map (updated by the program)
+
+// Prototypes for I2C.c functions:
+
+/**
+ * Function: void i2c_config(void)
+ *
+ * Configure the MSSP as an I2C slave at I2C_ADDRESS, and enable the MSSP
+ * interrupt. i2c_isr() must be set as the ISR_SSP handler in UBMP420.h.
+ */
+void i2c_config(void);
+
+/**
+ * Function: void i2c_publish(void)
+ *
+ * Copy the i2cData[] register map into the snapshot sent to the host. The host
+ * switches to the new snapshot at the start of its next read. Returns without
+ * waiting for the host, and can be called after every measurement.
+ *
+ * Example usage: i2c_publish();
+ */
+void i2c_publish(void);
+
+/**
+ * Function: void i2c_isr(void)
+ *
+ * MSSP I2C slave interrupt handler. Receives the register number and sends
+ * the register snapshot to the host. Called by the UBMP420.c interrupt
+ * dispatcher (ISR_SSP).
+ */
+void i2c_isr(void);
@@ -0,0 +1,242 @@
+/*==============================================================================
+ File: RANGE.c
+ Date: October 14, 2026
+
+ SONAR range processing functions
+
+ Functions that process the range samples produced by the SONAR functions
+ before they are used by the rest of the program. The range filter combines a
+ median filter, which rejects range spikes caused by missed or multi-path
+ echoes, with an integer exponential moving average (EMA) filter that smooths
+ out range jitter. The velocity estimator calculates the rate of change of the
+ range from a history of timestamped range samples, and the range event
+ functions report only changes between range bands, so that code using the
+ range has nothing to do while the range stays in the same band. Include the
+ RANGE.h file in your main program to call these functions.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "RANGE.h"           // Include range processing definitions
+
+// Range filter variables
+unsigned char rangeSamples[RANGE_FILTERS][RANGE_MEDIAN];   // Ring buffers of recent samples
+unsigned char rangeIndex[RANGE_FILTERS];    // Ring buffer index of the oldest sample
+unsigned int rangeEma[RANGE_FILTERS];       // EMA filtered range x 2^RANGE_EMA_SHIFT
+unsigned char rangeOutput[RANGE_FILTERS];   // Last filtered range (0 = filter empty)
+unsigned char rangeMisses[RANGE_FILTERS];   // Consecutive missed echoes
+
+// Range velocity variables
+unsigned char velocityRanges[RANGE_HISTORY];    // Ring buffer of recent ranges
+unsigned int velocityTimes[RANGE_HISTORY];      // Time of each range (ms)
+unsigned char velocityIndex = 0;    // Ring buffer index of the oldest sample
+unsigned char velocitySamples = 0;  // Samples saved (until history is full)
+
+// Range event variables
+const unsigned char *rangeThresholds;   // Registered band thresholds (cm)
+unsigned char rangeBands = 0;   // Number of band thresholds
+void (*rangeHandler)(unsigned char);    // Band change handler (or 0)
+unsigned char rangeBand = 0;    // Current range band (0 = lowest)
+bool rangeBandChanged = false;  // Band changed flag (cleared by user)
+
+// Velocity reciprocal table - (1000 x 2^RANGE_RECIP_SHIFT) / m for time
+// differences m of 64-127 (stored in program memory)
+const unsigned int rangeRecip[64] = {
+    RANGE_RECIP4(64), RANGE_RECIP4(68), RANGE_RECIP4(72), RANGE_RECIP4(76),
+    RANGE_RECIP4(80), RANGE_RECIP4(84), RANGE_RECIP4(88), RANGE_RECIP4(92),
+    RANGE_RECIP4(96), RANGE_RECIP4(100), RANGE_RECIP4(104), RANGE_RECIP4(108),
+    RANGE_RECIP4(112), RANGE_RECIP4(116), RANGE_RECIP4(120), RANGE_RECIP4(124)
+};
+
+// Swap a and b if a is greater than b (median filter compare-and-swap step)
+#define RANGE_SORT(a, b)    if(a > b) { temp = a; a = b; b = temp; }
+
+// Range filter function - add a new range sample to the filter, and return
+// the filtered range. Missed echoes hold the last output, or empty the filter
+// after RANGE_MISSES of them, so a 0 sample never reaches the median or EMA.
+unsigned char range_filter(unsigned char filter, unsigned char range)
+{
+    if(range == 0)
+    {
+        if(rangeOutput[filter] != 0)
+        {
+            rangeMisses[filter] ++;
+            if(rangeMisses[filter] == RANGE_MISSES)
+            {
+                rangeOutput[filter] = 0;    // Target lost - empty the filter
+            }
+        }
+        return(rangeOutput[filter]);
+    }
+    rangeMisses[filter] = 0;
+    if(rangeOutput[filter] == 0)
+    {
+        range_filter_reset(filter, range);  // Seed the filter with the first sample
+    }
+    
+    // Replace the oldest sample in the ring buffer with the new sample
+    unsigned char *samples = rangeSamples[filter];
+    unsigned char index = rangeIndex[filter];
+    samples[index] = range;
+    index ++;
+    if(index == RANGE_MEDIAN)
+    {
+        index = 0;
+    }
+    rangeIndex[filter] = index;
+    
+    // Find the median sample using a fixed sequence of compare-and-swap steps
+    unsigned char temp;
+    unsigned char a = samples[0];
+    unsigned char b = samples[1];
+    unsigned char c = samples[2];
+#if RANGE_MEDIAN == 5
+    unsigned char d = samples[3];
+    unsigned char e = samples[4];
+    RANGE_SORT(a, b);
+    RANGE_SORT(d, e);
+    RANGE_SORT(a, d);
+    RANGE_SORT(b, e);
+    RANGE_SORT(b, c);
+    RANGE_SORT(c, d);
+    RANGE_SORT(b, c);
+    range = c;
+#else
+    RANGE_SORT(a, b);
+    RANGE_SORT(b, c);
+    RANGE_SORT(a, b);
+    range = b;
+#endif
+
+#if RANGE_EMA_SHIFT > 0
+    // Move the filtered range 1/2^RANGE_EMA_SHIFT of the way to the median
+    unsigned int ema = rangeEma[filter];
+    ema = ema - (ema >> RANGE_EMA_SHIFT) + range;
+    rangeEma[filter] = ema;
+    range = (unsigned char)(ema >> RANGE_EMA_SHIFT);
+#endif
+    rangeOutput[filter] = range;    // Non-zero, since every sample is non-zero
+    return(range);
+}
+
+// Range filter reset function - fill the filter with the specified range, or
+// empty it if the range is 0.
+void range_filter_reset(unsigned char filter, unsigned char range)
+{
+    for(unsigned char i = 0; i != RANGE_MEDIAN; i++)
+    {
+        rangeSamples[filter][i] = range;
+    }
+    rangeEma[filter] = (unsigned int)range << RANGE_EMA_SHIFT;
+    rangeOutput[filter] = range;
+    rangeMisses[filter] = 0;
+}
+
+// Range velocity function - add a new timestamped range sample, and return the
+// velocity (cm/s) between the oldest and newest samples in the history.
+int range_velocity(unsigned char range, unsigned int time)
+{
+    // Replace the oldest sample in the ring buffer with the new sample
+    unsigned char oldRange = velocityRanges[velocityIndex];
+    unsigned int oldTime = velocityTimes[velocityIndex];
+    velocityRanges[velocityIndex] = range;
+    velocityTimes[velocityIndex] = time;
+    velocityIndex = (velocityIndex + 1) & (RANGE_HISTORY - 1);
+    if(velocitySamples != RANGE_HISTORY)
+    {
+        velocitySamples ++;     // History not full yet
+        return(0);
+    }
+    
+    // Find the change in range, and its direction
+    bool approaching = (range < oldRange);
+    unsigned char distance = approaching ? oldRange - range : range - oldRange;
+    
+    // Shift the time difference into the reciprocal table range (64-127),
+    // counting the shifts, to scale the velocity without dividing. The last
+    // right shift rounds, so long intervals are within half a table step.
+    unsigned int interval = time - oldTime;
+    if(interval == 0)
+    {
+        return(0);
+    }
+    unsigned char shift = RANGE_RECIP_SHIFT;
+    while(interval > 255)
+    {
+        interval = interval >> 1;
+        shift ++;
+    }
+    if(interval > 127)
+    {
+        interval = (interval + 1) >> 1;     // Round to the nearest step
+        shift ++;
+        if(interval == 128)
+        {
+            interval = 64;      // Rounded up past the end of the table
+            shift ++;
+        }
+    }
+    while(interval < 64)
+    {
+        interval = interval << 1;
+        shift --;
+    }
+    
+    // Velocity = distance x 1000 / interval (cm/s)
+    uint24_t product = (uint24_t)distance * rangeRecip[interval - 64];
+    product = product >> shift;
+    int velocity = (product > 32767) ? 32767 : (int)product;    // Limit to int
+    return(approaching ? -velocity : velocity);
+}
+
+// Range velocity reset function - fill the history with the specified sample.
+void range_velocity_reset(unsigned char range, unsigned int time)
+{
+    for(unsigned char i = 0; i != RANGE_HISTORY; i++)
+    {
+        velocityRanges[i] = range;
+        velocityTimes[i] = time;
+    }
+    velocitySamples = RANGE_HISTORY;
+}
+
+// Range event configuration function - register the band thresholds and
+// handler, and start in the lowest band.
+void range_event_config(const unsigned char *thresholds, unsigned char count, void (*handler)(unsigned char))
+{
+    rangeThresholds = thresholds;
+    rangeBands = count;
+    rangeHandler = handler;
+    rangeBand = 0;
+    rangeBandChanged = false;
+}
+
+// Range event function - move the range band up past each threshold the range
+// is above, or down past each threshold the range is RANGE_HYSTERESIS below,
+// and report the new band only if it has changed.
+unsigned char range_event(unsigned char range)
+{
+    unsigned char band = rangeBand;
+    while(band != rangeBands && range > rangeThresholds[band])
+    {
+        band ++;
+    }
+    while(band != 0 && range + RANGE_HYSTERESIS <= rangeThresholds[band - 1])
+    {
+        band --;
+    }
+    if(band == rangeBand)
+    {
+        return(RANGE_NO_EVENT);     // Same band - nothing to do
+    }
+    
+    rangeBand = band;
+    rangeBandChanged = true;
+    if(rangeHandler != 0)
+    {
+        rangeHandler(band);
+    }
+    return(band);
+}
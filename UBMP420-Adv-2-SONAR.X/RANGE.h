@@ -0,0 +1,138 @@
+/*==============================================================================
+ File: RANGE.h
+ Date: October 14, 2026
+
+ SONAR range processing symbolic constant and function definitions.
+
+ Range filter definitions section:
+ Settings for the median and exponential moving average (EMA) filter stages
+ used by the range_filter() function.
+
+ Range velocity definitions section:
+ Settings for the velocity estimator used by the range_velocity() function.
+
+ Range event definitions section:
+ Settings for the range band events detected by the range_event() function.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the RANGE.c file.
+==============================================================================*/
+
+// Range filter definitions. The median filter stage replaces each new range
+// sample with the median of the last RANGE_MEDIAN samples (3 or 5), removing
+// single (or, with 5 samples, double) spikes and missed echoes. The EMA filter
+// stage then smooths the median range by adding 1/2^RANGE_EMA_SHIFT of the
+// difference between the new range and the filtered range to the filtered
+// range each sample (set RANGE_EMA_SHIFT to 0 to disable the EMA stage).
+// Missed echoes (0 samples) never enter either stage. The filter holds its
+// last output through up to RANGE_MISSES - 1 consecutive misses, and reports
+// 0 (no target) after RANGE_MISSES of them. The next valid sample then fills
+// both stages, so the output restarts at the new range instead of ramping up
+// from the old one (or from 0).
+#define RANGE_MEDIAN        3           // Median filter samples (3 or 5)
+#define RANGE_EMA_SHIFT     2           // EMA filter weight (1/2^n, 0-8)
+#define RANGE_MISSES        4           // Misses before reporting no target
+
+// Each SONAR module is filtered separately, using its own one of RANGE_FILTERS
+// sets of filter state (the filter number is the module's sonarRanges[]
+// index). Set RANGE_FILTERS to SONAR_SENSORS when using the SONAR scanner or
+// parallel ranging functions, or to 1 for a single SONAR module.
+#define RANGE_FILTERS       1           // Independent range filters (1-4)
+
+// Range velocity definitions. The velocity estimator saves the last
+// RANGE_HISTORY (a power of 2) timestamped range samples, and calculates the
+// velocity from the change in range and time across all of them. The time
+// difference is shifted into the range of the RANGE_RECIP() reciprocal table
+// (64-127) so that the velocity is calculated using a multiplication and a
+// shift instead of a division. Longer time differences are rounded to the
+// nearest table entry as they are shifted, so the velocity has less than 0.8%
+// error (half of a 1/64 table step), plus under 1cm/s from truncating the
+// result.
+#define RANGE_HISTORY       8           // Velocity history samples (power of 2)
+#define RANGE_RECIP_SHIFT   12          // Reciprocal table scale (2^n)
+#define RANGE_RECIP(m)      ((unsigned int)((1000UL << RANGE_RECIP_SHIFT) / (m)))
+#define RANGE_RECIP4(m)     RANGE_RECIP(m), RANGE_RECIP(m + 1), RANGE_RECIP(m + 2), RANGE_RECIP(m + 3)
+
+// Range event definitions. The range_event() function divides the range into
+// bands at a list of ascending thresholds. The range moves up into the next
+// band when it is greater than the band's upper threshold, but only moves back
+// down when it is RANGE_HYSTERESIS cm or more below the threshold, so a range
+// jittering around a threshold doesn't produce a stream of band change events.
+#define RANGE_HYSTERESIS    1           // Band change hysteresis (cm)
+#define RANGE_NO_EVENT      0xFF        // range_event() result if band unchanged
+
+// Range event variables
+extern unsigned char rangeBand;         // Current range band (0 = lowest)
+extern bool rangeBandChanged;           // Band changed flag (clear after use)
+
+// Prototypes for RANGE.c functions:
+
+/**
+ * Function: unsigned char range_filter(unsigned char filter, unsigned char range)
+ *
+ * Add a new range sample to the specified range filter (0 to RANGE_FILTERS - 1)
+ * and return the filtered range, or 0 if there is no target. A 0 (missed echo)
+ * sample returns the last filtered range until RANGE_MISSES consecutive
+ * misses, and then 0. The first valid sample after a reset or a lost target
+ * re-fills the filter. No division is used.
+ *
+ * Example usage: distance = range_filter(0, sonar_read());
+ */
+unsigned char range_filter(unsigned char, unsigned char);
+
+/**
+ * Function: void range_filter_reset(unsigned char filter, unsigned char range)
+ *
+ * Fill the specified range filter with the specified range (e.g. after a long
+ * gap in measurements) so that the filter output starts at this range, or
+ * empty the filter (range 0) so that it is re-filled by the next valid sample.
+ *
+ * Example usage: range_filter_reset(0, 0);
+ */
+void range_filter_reset(unsigned char, unsigned char);
+
+/**
+ * Function: int range_velocity(unsigned char range, unsigned int time)
+ *
+ * Add a new timestamped range sample (time in ms, e.g. taskTime) to the
+ * velocity history, and return the velocity in cm/s over the history. The
+ * velocity is negative when the target is approaching, and 0 until the
+ * history has been filled. Add only valid (non-zero) range samples.
+ *
+ * Example usage: velocity = range_velocity(distance, taskTime);
+ */
+int range_velocity(unsigned char, unsigned int);
+
+/**
+ * Function: void range_velocity_reset(unsigned char range, unsigned int time)
+ *
+ * Fill the velocity history with the specified range and time (e.g. after a
+ * long gap in measurements) so that the velocity starts at 0.
+ *
+ * Example usage: range_velocity_reset(distance, taskTime);
+ */
+void range_velocity_reset(unsigned char, unsigned int);
+
+/**
+ * Function: void range_event_config(const unsigned char *thresholds,
+ *              unsigned char count, void (*handler)(unsigned char band))
+ *
+ * Register a list of count ascending band thresholds (in cm) for range_event(),
+ * and an optional handler function (or 0 to poll rangeBandChanged instead)
+ * that is called with the new band each time the range changes band. Band 0 is
+ * up to and including the first threshold, and band count is above the last.
+ *
+ * Example usage: range_event_config(bands, 4, band_changed);
+ */
+void range_event_config(const unsigned char *, unsigned char, void (*)(unsigned char));
+
+/**
+ * Function: unsigned char range_event(unsigned char range)
+ *
+ * Check a new range sample against the registered band thresholds. Returns the
+ * new band, after calling the handler and setting rangeBandChanged, if the
+ * range has changed bands, or RANGE_NO_EVENT if the band is unchanged.
+ *
+ * Example usage: range_event(distance);
+ */
+unsigned char range_event(unsigned char);
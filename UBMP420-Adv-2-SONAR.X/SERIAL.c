@@ -0,0 +1,127 @@
+/*==============================================================================
+ File: SERIAL.c
+ Date: October 14, 2026
+
+ EUSART serial telemetry functions
+
+ Interrupt-driven serial transmit functions. Bytes written by the program are
+ stored in a ring buffer and sent by the EUSART transmit interrupt, so sending
+ data takes only a few instructions and never waits for the serial port. The
+ serial_frame() function sends SONAR range samples as compact binary frames
+ for logging and tuning. Include the SERIAL.h file in your main program to
+ call these functions, and enable TELEMETRY in CONFIG.h to compile them.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "SERIAL.h"          // Include serial telemetry definitions
+
+#ifdef TELEMETRY
+
+// Transmit ring buffer. serialHead is only written by the program, and
+// serialTail is only written by serial_tx_isr(), so single-byte reads of the
+// other index are safe without disabling interrupts. Both indexes and the
+// buffer are shared with serial_tx_isr(), so they are all volatile, keeping
+// each byte's buffer write ahead of the serialHead update that releases it.
+volatile unsigned char serialBuffer[SERIAL_BUFFER]; // Transmit buffer
+volatile unsigned char serialHead = 0;  // Buffer index of the next byte to write
+volatile unsigned char serialTail = 0;  // Buffer index of the next byte to send
+unsigned char serialDropped = 0;    // Frames dropped because buffer was full
+
+// Return the number of free bytes in the transmit buffer. One byte is always
+// left empty so that a full buffer can be told apart from an empty one.
+static unsigned char serial_free(void)
+{
+    return((unsigned char)(serialTail - serialHead - 1) & (SERIAL_BUFFER - 1));
+}
+
+// Configure the EUSART for asynchronous transmit at SERIAL_BAUD.
+void serial_config(void)
+{
+    WPUB = WPUB & 0b01111111;  // Disable SW5 pull-up on TX pin
+    TRISBbits.TRISB7 = 0;       // Set TX pin as output
+    BAUDCON = 0b00001000;       // Use 16-bit baud rate generator (BRG16)
+    SPBRGH = (unsigned char)(SERIAL_BRG >> 8);
+    SPBRGL = (unsigned char)SERIAL_BRG;
+    TXSTA = 0b00100100;         // Enable 8-bit asynchronous transmit, BRGH
+    RCSTA = 0b10000000;         // Enable serial port (SPEN), receiver off
+    TXIE = 0;                   // Transmit interrupt on when buffer has data
+}
+
+// Add a byte to the transmit buffer - returns false if the buffer is full.
+bool serial_write(unsigned char data)
+{
+    if(serial_free() == 0)
+    {
+        return(false);
+    }
+    serialBuffer[serialHead] = data;
+    serialHead = (serialHead + 1) & (SERIAL_BUFFER - 1);
+    TXIE = 1;                   // Start (or continue) sending
+    return(true);
+}
+
+// Add a complete telemetry frame to the transmit buffer, or drop it.
+bool serial_frame(unsigned char id, unsigned char range, unsigned int time)
+{
+    if(serial_free() < SERIAL_FRAME_SIZE)
+    {
+        serialDropped ++;
+        return(false);
+    }
+    unsigned char timeL = (unsigned char)time;
+    unsigned char timeH = (unsigned char)(time >> 8);
+    serial_write(SERIAL_SYNC);
+    serial_write(id);
+    serial_write(range);
+    serial_write(timeL);
+    serial_write(timeH);
+    serial_write((unsigned char)(0 - (SERIAL_SYNC + id + range + timeL + timeH)));
+    return(true);
+}
+
+// Add a complete variable length packet to the transmit buffer, or drop it.
+bool serial_packet(unsigned char sync, const unsigned char *data, unsigned char length)
+{
+    if(serial_free() < length + 3)
+    {
+        serialDropped ++;
+        return(false);
+    }
+    unsigned char sum = sync + length;
+    serial_write(sync);
+    serial_write(length);
+    while(length != 0)
+    {
+        sum += *data;
+        serial_write(*data);
+        data ++;
+        length --;
+    }
+    serial_write((unsigned char)(0 - sum));
+    return(true);
+}
+
+// EUSART transmit interrupt handler - send the next byte from the buffer, and
+// turn off the transmit interrupt once the buffer is empty (writing TXREG
+// clears TXIF). The buffer is checked first in case serial_write() re-enabled
+// the interrupt just after the last byte was sent.
+void serial_tx_isr(void)
+{
+    if(serialTail == serialHead)
+    {
+        TXIE = 0;
+        return;
+    }
+    TXREG = serialBuffer[serialTail];
+    serialTail = (serialTail + 1) & (SERIAL_BUFFER - 1);
+    if(serialTail == serialHead)
+    {
+        TXIE = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*==============================================================================
+ File: SERIAL.h
+ Date: October 14, 2026
+
+ EUSART serial telemetry symbolic constant and function definitions.
+
+ Serial port definitions section:
+ EUSART baud rate and transmit buffer settings.
+
+ Telemetry frame definitions section:
+ Layout of the binary range telemetry frames sent by serial_frame().
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the SERIAL.c file.
+==============================================================================*/
+
+// Serial port definitions. The EUSART transmits on the TX pin (RB7), which is
+// shared with pushbutton SW5, so SW5 can't be used while serial transmit is
+// enabled. Connect RB7 to the RX input of a 5V (or 5V tolerant) TTL serial
+// adapter. SERIAL_BRG sets the 16-bit baud rate generator for high speed
+// (BRGH = 1, BRG16 = 1) operation, giving 115385 baud (+0.16%) at 48 MHz.
+#define SERIAL_BAUD     115200      // Serial baud rate (bits/s)
+#define SERIAL_BRG      ((_XTAL_FREQ / 4 / SERIAL_BAUD) - 1)  // SPBRG value
+#define SERIAL_BUFFER   32          // Transmit buffer size (power of 2 bytes)
+
+// Telemetry frame definitions. Each frame is SERIAL_FRAME_SIZE bytes long:
+// SERIAL_SYNC, sensor id, range (cm), 16-bit timestamp (ms, low byte first),
+// and a checksum byte that makes the sum of all frame bytes 0 (modulo 256).
+// A frame takes 0.52ms to send at 115200 baud. Range sample frames use sensor
+// ids 0-127. Setting SERIAL_BAND_EVENT (bit 7) in the id byte marks a range
+// band change frame instead, with the new band number in the low 7 bits.
+#define SERIAL_SYNC     0xA5        // Frame start byte
+#define SERIAL_FRAME_SIZE 6         // Telemetry frame length (bytes)
+#define SERIAL_BAND_EVENT 0x80      // Id byte flag for band change frames
+
+extern unsigned char serialDropped; // Frames dropped because buffer was full
+
+// Prototypes for SERIAL.c functions:
+
+/**
+ * Function: void serial_config(void)
+ *
+ * Configure the EUSART to transmit at SERIAL_BAUD using the TX pin (RB7).
+ */
+void serial_config(void);
+
+/**
+ * Function: bool serial_write(unsigned char data)
+ *
+ * Add a byte to the transmit buffer to be sent in the background, and return
+ * immediately. Returns false (and drops the byte) if the buffer is full.
+ *
+ * Example usage: serial_write('A');
+ */
+bool serial_write(unsigned char);
+
+/**
+ * Function: bool serial_frame(unsigned char id, unsigned char range, unsigned int time)
+ *
+ * Add a binary telemetry frame to the transmit buffer and return immediately.
+ * The complete frame is dropped (and serialDropped is incremented) if there is
+ * not enough space in the buffer for all of it, so the program never waits for
+ * the serial port, and frames are never sent partially.
+ *
+ * Example usage: serial_frame(0, distance, taskTime);
+ */
+bool serial_frame(unsigned char, unsigned char, unsigned int);
+
+/**
+ * Function: bool serial_packet(unsigned char sync, const unsigned char *data, unsigned char length)
+ *
+ * Add a variable length packet to the transmit buffer and return immediately.
+ * Packets are made up of the sync byte, the data length, length data bytes,
+ * and a checksum byte that makes the sum of all packet bytes 0 (modulo 256).
+ * The packet is dropped (and serialDropped is incremented) if it doesn't fit
+ * in the buffer (SERIAL_BUFFER - 4 data bytes at most).
+ *
+ * Example usage: serial_packet(STATS_SYNC, (unsigned char *)&stats, sizeof(stats));
+ */
+bool serial_packet(unsigned char, const unsigned char *, unsigned char);
+
+/**
+ * Function: void serial_tx_isr(void)
+ *
+ * EUSART transmit interrupt handler. Sends the next byte in the transmit
+ * buffer. Called by the UBMP420.c interrupt dispatcher (ISR_TX).
+ */
+void serial_tx_isr(void);
@@ -0,0 +1,1150 @@
+/*==============================================================================
+ File: SONAR.c
+ Date: October 14, 2026
+
+ HC-SR04 SONAR module distance measurement functions
+
+ Two ways of measuring SONAR range are provided. The sonar_range() function
+ counts unit-length time delays while the ECHO pulse is active, blocking the
+ program until the pulse ends, using a cycle-counted assembly language kernel
+ so that every count is exactly one unit long. The interrupt-driven functions (sonar_config(),
+ sonar_start() and sonar_read()) time the ECHO pulse in hardware: the INT pin
+ interrupt on ECHO (RC1) starts Timer1 when the ECHO pulse begins and captures
+ Timer1 when the pulse ends, leaving the main program free to do other work
+ while a measurement is in progress. Include the SONAR.h file in your main
+ program to call these functions.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "SONAR.h"           // Include SONAR constant & function definitions
+#include    "STATS.h"           // Include instrumentation counter definitions
+
+// SONAR measurement engine variables (shared with the interrupt handlers)
+volatile unsigned int sonarPulse;   // ECHO pulse length (Timer1 ticks)
+volatile bool sonarDone = false;    // New sonarPulse result is ready
+volatile bool sonarBusy = false;    // SONAR measurement in progress
+volatile unsigned char sonarStatus = SONAR_OK;  // Last measurement status
+volatile bool sonarDraining = false;    // Waiting for beyond-range ECHO to end
+// Timer1 preloads and times are uint16_t so that they also wrap at 16 bits in
+// SONAR_HOST builds, where unsigned int is wider than Timer1.
+uint16_t sonarEchoStart = (uint16_t)(0 - (SONAR_MAX_RANGE * SONAR_TICKS_PER_CM));  // Timer1 preload
+uint16_t sonarEchoBase = (uint16_t)(0 - (SONAR_MAX_RANGE * SONAR_TICKS_PER_CM) - SONAR_OFFSET_TICKS);
+uint16_t sonarEchoBlank = (uint16_t)(0 - (SONAR_MAX_RANGE * SONAR_TICKS_PER_CM) + SONAR_BLANK_TICKS);
+#ifdef STATS
+volatile unsigned int sonarWaitTicks;   // Ticks from arm to ECHO start (STATS)
+#endif
+
+// SONAR counting kernel variables (bank 0, next to PORTC, see SONAR.h)
+volatile unsigned char sonarKernel[SONAR_KERNEL_SIZE] __at(SONAR_KERNEL_ADDRESS);
+
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+// SONAR scanner variables
+unsigned char sonarRanges[SONAR_SENSORS];   // Range of each module (cm)
+unsigned char sonarUpdated = 0;     // Bit set for each updated sonarRanges[]
+#endif
+
+#ifdef SONAR_PARALLEL
+// SONAR parallel ranging variables
+unsigned int sonarBlockedTicks = 0; // Timer1 ticks of the last interrupts-off ping
+#endif
+
+#ifdef SONAR_MULTI_ECHO
+// SONAR multi-echo capture variables
+volatile unsigned int sonarEdges[SONAR_EDGES];  // ECHO edge times (ticks)
+volatile unsigned char sonarEdgeCount = 0;  // Number of ECHO edges saved
+volatile bool sonarCapturing = false;   // ECHO started, saving ECHO edges
+volatile bool sonarBlanked = false;     // ECHO pulse discarded by blanking
+#endif
+
+#ifdef SONAR_TEMP_COMP
+// SONAR temperature compensation tables (one entry per 5C band from -10C)
+const unsigned int sonarTempLimit[SONAR_TEMP_BANDS - 1] = {     // Band upper limits
+    SONAR_TEMP_ADC(-75), SONAR_TEMP_ADC(-25), SONAR_TEMP_ADC(25), SONAR_TEMP_ADC(75),
+    SONAR_TEMP_ADC(125), SONAR_TEMP_ADC(175), SONAR_TEMP_ADC(225), SONAR_TEMP_ADC(275),
+    SONAR_TEMP_ADC(325), SONAR_TEMP_ADC(375)
+};
+const unsigned char sonarTempParams[SONAR_TEMP_BANDS][SONAR_PARAMS_SIZE] = {  // Kernel parameters
+    SONAR_TEMP_PARAMS(-10), SONAR_TEMP_PARAMS(-5), SONAR_TEMP_PARAMS(0), SONAR_TEMP_PARAMS(5),
+    SONAR_TEMP_PARAMS(10), SONAR_TEMP_PARAMS(15), SONAR_TEMP_PARAMS(20), SONAR_TEMP_PARAMS(25),
+    SONAR_TEMP_PARAMS(30), SONAR_TEMP_PARAMS(35), SONAR_TEMP_PARAMS(40)
+};
+const int sonarTempScales[SONAR_TEMP_BANDS] = {     // Pulse corrections
+    SONAR_TEMP_SCALE(-10), SONAR_TEMP_SCALE(-5), SONAR_TEMP_SCALE(0), SONAR_TEMP_SCALE(5),
+    SONAR_TEMP_SCALE(10), SONAR_TEMP_SCALE(15), SONAR_TEMP_SCALE(20), SONAR_TEMP_SCALE(25),
+    SONAR_TEMP_SCALE(30), SONAR_TEMP_SCALE(35), SONAR_TEMP_SCALE(40)
+};
+
+// SONAR temperature compensation variables (default to the 20C band)
+unsigned int sonarTempReading;  // Temperature indicator reading (10-bit)
+unsigned char sonarTempBand = 6;    // Temperature band (0 = -10C, 5C steps)
+signed char sonarTempShifts[SONAR_TEMP_TERMS];  // Correction term shifts (- to subtract, 0 unused)
+#endif
+
+#ifdef SONAR_SCAN
+const unsigned char sonarTrigPins[4] = {SONAR1_TRIG, SONAR2_TRIG, SONAR3_TRIG, SONAR4_TRIG};
+unsigned char sonarSensor = 0;      // Module being pinged by sonar_scan()
+unsigned char sonarGuard = 0;       // Guard time until next ping (ms)
+#endif
+
+// Assembly language helpers - SONAR_STR() turns a constant expression into a
+// string, and SONAR_K() addresses byte n of the kernel variables.
+#define SONAR_STR(x)        SONAR_STR_(x)
+#define SONAR_STR_(x)       #x
+#define SONAR_K(n)          "_sonarKernel+(" SONAR_STR(n) ")"
+#define SONAR_ECHO_BIT      SONAR_STR(PIN_BIT(ECHO_PIN))
+
+#ifdef SONAR_HOST
+// Kernel delay model - delays for the cycles used by the kernel delay with
+// the delay parameters at sonarKernel[param].
+static void sonar_kernel_delay(unsigned char param)
+{
+    unsigned char pad = sonarKernel[param + 2];
+    unsigned int inner = (sonarKernel[param] == 0) ? 256 : sonarKernel[param];
+    SONAR_DELAY(12 + 3 * inner + 770UL * (unsigned char)(sonarKernel[param + 1] - 1)
+        + (pad & 1) + ((pad >> 1) & 1) + ((pad >> 2) & 1) + ((pad >> 3) & 1));
+}
+
+// SONAR counting kernel model for host builds - makes the same ECHO checks as
+// the assembly language kernel below, delaying for the cycles used by the
+// kernel's instructions between them.
+void sonar_kernel(void)
+{
+    unsigned char outer = sonarKernel[SONAR_K_WAIT + 1];
+    unsigned char inner = sonarKernel[SONAR_K_WAIT];
+    
+    SONAR_DELAY(4);
+    while(ECHO == 0)
+    {
+        SONAR_DELAY(3);
+        inner --;
+        if(inner != 0)
+        {
+            SONAR_DELAY(2);
+            continue;
+        }
+        SONAR_DELAY(2);
+        outer --;
+        if(outer != 0)
+        {
+            SONAR_DELAY(2);
+            continue;
+        }
+        SONAR_DELAY(3);
+        sonarKernel[SONAR_K_STATUS] = SONAR_NO_SENSOR;
+        return;
+    }
+    SONAR_DELAY(SONAR_RISE_CYCLES);
+    sonarKernel[SONAR_K_WAIT] = inner;
+    sonarKernel[SONAR_K_WAIT + 1] = outer;
+    sonar_kernel_delay(SONAR_K_BLANK);
+    if(ECHO == 0)
+    {
+        sonarKernel[SONAR_K_STATUS] = SONAR_BLANKED;
+        return;
+    }
+    SONAR_DELAY(SONAR_BLANK_SKIP);
+    sonar_kernel_delay(SONAR_K_FIRST);
+    while(ECHO == 1)
+    {
+        SONAR_DELAY(2);
+        sonar_kernel_delay(SONAR_K_UNIT);
+        sonarKernel[SONAR_K_RANGE] ++;
+        if(sonarKernel[SONAR_K_RANGE] == sonarKernel[SONAR_K_MAX])
+        {
+            SONAR_DELAY(6);
+            sonarKernel[SONAR_K_STATUS] = SONAR_NO_ECHO;
+            return;
+        }
+        SONAR_DELAY(SONAR_COUNT_CYCLES - 2);
+    }
+    sonarKernel[SONAR_K_STATUS] = SONAR_OK;
+}
+#else
+// SONAR counting kernel - wait for the ECHO pulse to start, check that it
+// lasts longer than the blanking window, and count range units until it ends
+// or the range reaches the maximum, using the parameters in sonarKernel[].
+// The kernel variables and PORTC are both in bank 0, and every delay is a
+// KERNEL_DELAY() block, so the cycles used by every instruction (listed in
+// each comment) don't depend on the data. W is the inner delay loop counter
+// (decfsz WREG is 3 cycles per pass and 2 for the last, and W = 0 counts 256
+// passes). Must be called with interrupts disabled.
+#define KERNEL_DELAY(param)                                                   \
+    asm("movf " SONAR_K(param + 1) ",w");   /* 1  Outer loop count */       \
+    asm("movwf " SONAR_K(SONAR_K_OUTER));   /* 1 */                         \
+    asm("movf " SONAR_K(param) ",w");       /* 1  Inner loop count */       \
+    asm("decfsz WREG,f");                   /* 3l - 1 inner loop */         \
+    asm("bra $-1");                                                         \
+    asm("decfsz " SONAR_K(SONAR_K_OUTER) ",f"); /* 770(h - 1) + 2 */        \
+    asm("bra $-3");                                                         \
+    asm("btfsc " SONAR_K(param + 2) ",0");  /* 8 + padding bits set */      \
+    asm("bra $+1");                                                         \
+    asm("btfsc " SONAR_K(param + 2) ",1");                                  \
+    asm("bra $+1");                                                         \
+    asm("btfsc " SONAR_K(param + 2) ",2");                                  \
+    asm("bra $+1");                                                         \
+    asm("btfsc " SONAR_K(param + 2) ",3");                                  \
+    asm("bra $+1")
+
+void sonar_kernel(void)
+{
+    asm("movlb 0");                         // 1  Select bank 0
+    asm("movf " SONAR_K(SONAR_K_WAIT + 1) ",w");    // 1  Load wait counters
+    asm("movwf " SONAR_K(SONAR_K_OUTER));   // 1
+    asm("movf " SONAR_K(SONAR_K_WAIT) ",w");    // 1
+    asm("sonar_kernel_wait:");              // Wait for ECHO to start:
+    asm("btfsc PORTC," SONAR_ECHO_BIT);     // 2  (1 when ECHO is high)
+    asm("bra sonar_kernel_rise");           //    (2)
+    asm("decfsz WREG,f");                   // 1  (2 every 256 passes)
+    asm("bra sonar_kernel_wait");           // 2
+    asm("decfsz " SONAR_K(SONAR_K_OUTER) ",f");
+    asm("bra sonar_kernel_wait");
+    asm("movlw " SONAR_STR(SONAR_NO_SENSOR));   // ECHO didn't start
+    asm("bra sonar_kernel_end");
+    asm("sonar_kernel_rise:");              // ECHO started:
+    asm("movwf " SONAR_K(SONAR_K_WAIT));    // 1  Save wait counters (STATS)
+    asm("movf " SONAR_K(SONAR_K_OUTER) ",w");   // 1
+    asm("movwf " SONAR_K(SONAR_K_WAIT + 1));    // 1
+    KERNEL_DELAY(SONAR_K_BLANK);            //    Blanking delay
+    asm("btfss PORTC," SONAR_ECHO_BIT);     // 2  (1 when ECHO is low)
+    asm("bra sonar_kernel_blanked");        //    (2)
+    KERNEL_DELAY(SONAR_K_FIRST);            //    First count check delay
+    asm("sonar_kernel_count:");             // Count range units:
+    asm("btfss PORTC," SONAR_ECHO_BIT);     // 2  (1 when ECHO is low)
+    asm("bra sonar_kernel_echo");           //    (2)
+    KERNEL_DELAY(SONAR_K_UNIT);             //    Counting pass delay
+    asm("incf " SONAR_K(SONAR_K_RANGE) ",f");   // 1
+    asm("movf " SONAR_K(SONAR_K_RANGE) ",w");   // 1
+    asm("xorwf " SONAR_K(SONAR_K_MAX) ",w");    // 1
+    asm("btfss STATUS,2");                  // 1  Z is set at maximum range
+    asm("bra sonar_kernel_count");          // 2
+    asm("movlw " SONAR_STR(SONAR_NO_ECHO)); // No ECHO within maximum range
+    asm("bra sonar_kernel_end");
+    asm("sonar_kernel_blanked:");           // ECHO ended inside blanking window
+    asm("movlw " SONAR_STR(SONAR_BLANKED));
+    asm("bra sonar_kernel_end");
+    asm("sonar_kernel_echo:");              // ECHO ended - range counted
+    asm("movlw " SONAR_STR(SONAR_OK));
+    asm("sonar_kernel_end:");
+    asm("movwf " SONAR_K(SONAR_K_STATUS));
+}
+#endif
+
+#ifdef STATS
+// Return the ECHO start wait passes left in the kernel's wait counters.
+static unsigned int sonar_wait_left(void)
+{
+    return(((unsigned int)(unsigned char)(sonarKernel[SONAR_K_WAIT + 1] - 1) << 8)
+        + (unsigned char)(sonarKernel[SONAR_K_WAIT] - 1) + 1);
+}
+
+// Return the cycles taken by the kernel delay set by the delay parameters
+// starting at sonarKernel[param].
+static unsigned int sonar_delay_cycles(unsigned char param)
+{
+    unsigned char pad = sonarKernel[param + 2];
+    return(12 + 3 * ((unsigned char)(sonarKernel[param] - 1) + 1)
+        + 770 * (sonarKernel[param + 1] - 1)
+        + (pad & 1) + ((pad >> 1) & 1) + ((pad >> 2) & 1) + ((pad >> 3) & 1));
+}
+
+// Count the result of a blocking measurement. The ECHO start wait passes are
+// found from the wait counters saved by the kernel, and the unit length from
+// the counting pass delay parameters.
+static void sonar_count_stats(void)
+{
+    STATS_INC(pings);
+    if(sonarStatus == SONAR_NO_SENSOR)
+    {
+        STATS_INC(noSensor);
+        STATS_ADD(waitCycles, (unsigned long)SONAR_START_LOOPS * SONAR_WAIT_CYCLES);
+        return;
+    }
+    unsigned int waitLeft = sonar_wait_left();
+    STATS_ADD(waitCycles, (unsigned long)(SONAR_START_LOOPS - waitLeft) * SONAR_WAIT_CYCLES);
+    if(sonarStatus == SONAR_BLANKED)
+    {
+        STATS_INC(blanked);
+        return;
+    }
+    unsigned int unitCycles = SONAR_COUNT_CYCLES + sonar_delay_cycles(SONAR_K_UNIT);
+    STATS_ADD(countCycles, (unsigned long)sonarKernel[SONAR_K_RANGE] * unitCycles);
+    if(sonarStatus == SONAR_NO_ECHO)
+    {
+        STATS_INC(noEcho);
+        return;
+    }
+    STATS_INC(echoes);
+}
+#define SONAR_COUNT_STATS() sonar_count_stats()
+#else
+#define SONAR_COUNT_STATS()
+#endif
+
+#if defined(STATS) && defined(SONAR_PARALLEL)
+// Count the result of a parallel measurement, the same way as a blocking
+// measurement. All of the modules are pinged together, so each parallel ping
+// counts once, as echoes if every module's ECHO pulse ended within range.
+static void sonar_parallel_stats(void)
+{
+    STATS_INC(pings);
+    if(sonarStatus == SONAR_NO_SENSOR)
+    {
+        STATS_INC(noSensor);
+        STATS_ADD(waitCycles, (unsigned long)SONAR_PARALLEL_LOOPS * SONAR_PARALLEL_WAIT_CYCLES);
+        return;
+    }
+    unsigned int waitLeft = sonar_wait_left();
+    STATS_ADD(waitCycles, (unsigned long)(SONAR_PARALLEL_LOOPS - waitLeft) * SONAR_PARALLEL_WAIT_CYCLES);
+    unsigned int unitCycles = SONAR_PARALLEL_CYCLES + sonar_delay_cycles(SONAR_K_UNIT);
+    STATS_ADD(countCycles, (unsigned long)sonarKernel[SONAR_K_RANGE] * unitCycles);
+    if(sonarStatus == SONAR_NO_ECHO)
+    {
+        STATS_INC(noEcho);
+        return;
+    }
+    STATS_INC(echoes);
+}
+#define SONAR_PARALLEL_STATS()  sonar_parallel_stats()
+#else
+#define SONAR_PARALLEL_STATS()
+#endif
+
+// Range counting function used by each range function. Triggers a new
+// measurement and counts the ECHO pulse in the counting kernel using the
+// range unit's kernel parameters. Interrupts are disabled from the TRIG pulse
+// until the kernel returns, so that no interrupt handler can lengthen a pass.
+// Returns the range, or 0 and the reason in sonarStatus.
+static unsigned char sonar_count(const unsigned char *params)
+{
+    // The SONAR module cannot be re-triggered until the last ECHO pulse ends
+    if(ECHO == 1)
+    {
+        sonarStatus = SONAR_NOT_READY;
+        STATS_INC(notReady);
+        return(0);
+    }
+    
+    // Load the range unit's parameters and the timeouts into the kernel
+    for(unsigned char i = 0; i != SONAR_PARAMS_SIZE - 1; i++)
+    {
+        sonarKernel[SONAR_K_BLANK + i] = params[i];
+    }
+    sonarKernel[SONAR_K_RANGE] = params[SONAR_PARAMS_SIZE - 1];
+    sonarKernel[SONAR_K_WAIT] = (unsigned char)SONAR_START_LOOPS;
+    sonarKernel[SONAR_K_WAIT + 1] = (unsigned char)((SONAR_START_LOOPS - 1) >> 8) + 1;
+    sonarKernel[SONAR_K_MAX] = SONAR_MAX_RANGE;
+    
+    // Make TRIGger pulse to start a new measurement, and count the ECHO pulse
+    bool interrupts = GIE;
+    GIE = 0;
+    TRIG = 1;
+    SONAR_DELAY_US(20);
+    TRIG = 0;
+    sonar_kernel();
+    GIE = interrupts;
+    
+    sonarStatus = sonarKernel[SONAR_K_STATUS];
+    SONAR_COUNT_STATS();
+    if(sonarStatus != SONAR_OK)
+    {
+        return(0);
+    }
+    return(sonarKernel[SONAR_K_RANGE]);
+}
+
+#ifdef SONAR_RANGE_CM
+#ifdef SONAR_TEMP_COMP
+// Temperature compensated SONAR range function - count cm at the speed of
+// sound of the temperature band selected by sonar_temp_update().
+unsigned char sonar_range_cm(void)
+{
+    return(sonar_count(sonarTempParams[sonarTempBand]));
+}
+#else
+const unsigned char sonarCmParams[SONAR_PARAMS_SIZE] = SONAR_UNIT_PARAMS(SONAR_CM_TIME);
+
+// SONAR range function - return range to the closest target in cm, or 0 and
+// the reason in sonarStatus if the measurement times out.
+unsigned char sonar_range_cm(void)
+{
+    return(sonar_count(sonarCmParams));
+}
+#endif
+#endif
+
+#ifdef SONAR_RANGE_HCM
+const unsigned char sonarHcmParams[SONAR_PARAMS_SIZE] = SONAR_UNIT_PARAMS(SONAR_HCM_TIME);
+
+// SONAR range function - return range to the closest target in 0.5cm units.
+unsigned char sonar_range_hcm(void)
+{
+    return(sonar_count(sonarHcmParams));
+}
+#endif
+
+#ifdef SONAR_RANGE_MM2
+const unsigned char sonarMm2Params[SONAR_PARAMS_SIZE] = SONAR_UNIT_PARAMS(SONAR_MM2_TIME);
+
+// SONAR range function - return range to the closest target in 2mm units.
+unsigned char sonar_range_mm2(void)
+{
+    return(sonar_count(sonarMm2Params));
+}
+#endif
+
+#ifdef SONAR_RANGE_IN
+const unsigned char sonarInParams[SONAR_PARAMS_SIZE] = SONAR_UNIT_PARAMS(SONAR_IN_TIME);
+
+// SONAR range function - return range to the closest target in inches.
+unsigned char sonar_range_in(void)
+{
+    return(sonar_count(sonarInParams));
+}
+#endif
+
+#ifdef SONAR_PARALLEL
+// Parallel kernel delay parameters: the first ECHO check delay after the first
+// ECHO pulse starts, and the counting pass delay.
+const unsigned char sonarParallelParams[6] = {
+    SONAR_DELAY_PARAMS(SONAR_UNIT_CYCLES(SONAR_CM_TIME) / 2 - SONAR_PARALLEL_LATENCY),
+    SONAR_DELAY_PARAMS(SONAR_UNIT_CYCLES(SONAR_CM_TIME) - SONAR_PARALLEL_CYCLES)
+};
+
+#ifdef SONAR_HOST
+// Parallel counting kernel model for host builds - makes the same ECHO checks
+// as the assembly language kernel below, at the same instruction cycles.
+static void sonar_parallel_kernel(void)
+{
+    SONAR_DELAY(1);
+    while(ECHOES == 0)
+    {
+        SONAR_DELAY(5);
+        sonarKernel[SONAR_K_WAIT] --;
+        if(sonarKernel[SONAR_K_WAIT] != 0)
+        {
+            SONAR_DELAY(2);
+            continue;
+        }
+        SONAR_DELAY(2);
+        sonarKernel[SONAR_K_WAIT + 1] --;
+        if(sonarKernel[SONAR_K_WAIT + 1] != 0)
+        {
+            SONAR_DELAY(2);
+            continue;
+        }
+        sonarKernel[SONAR_K_STATUS] = SONAR_NO_SENSOR;
+        return;
+    }
+    SONAR_DELAY(5);
+    sonar_kernel_delay(SONAR_K_FIRST);
+    SONAR_DELAY(2);
+    while(1)
+    {
+        unsigned char echo = ECHOES;
+        sonarKernel[SONAR_K_ECHO] = echo;
+        sonarKernel[SONAR_K_STARTED] |= echo;
+        if(echo & SONAR1_ECHO)
+        {
+            sonarKernel[SONAR_K_RANGES] ++;
+        }
+#if SONAR_SENSORS > 1
+        if(echo & SONAR2_ECHO)
+        {
+            sonarKernel[SONAR_K_RANGES + 1] ++;
+        }
+#endif
+#if SONAR_SENSORS > 2
+        if(echo & SONAR3_ECHO)
+        {
+            sonarKernel[SONAR_K_RANGES + 2] ++;
+        }
+#endif
+        SONAR_DELAY(SONAR_PARALLEL_CYCLES);
+        sonarKernel[SONAR_K_RANGE] ++;
+        if(sonarKernel[SONAR_K_RANGE] == sonarKernel[SONAR_K_MAX] ||
+            (echo == 0 && sonarKernel[SONAR_K_STARTED] == SONAR_ECHO_PINS))
+        {
+            break;
+        }
+        sonar_kernel_delay(SONAR_K_UNIT);
+    }
+    sonarKernel[SONAR_K_STATUS] = SONAR_OK;
+}
+#else
+// Parallel SONAR counting kernel - wait for the first ECHO pulse to start,
+// then read all ECHO pins each pass and count the range of every module whose
+// ECHO pin is high, until all started ECHO pulses end or the pass count
+// reaches the maximum range. Every ECHO pin test (btfsc/incf) takes 2 cycles
+// whether ECHO is high or low, so each pass takes the same number of cycles.
+// Must be called with interrupts disabled.
+static void sonar_parallel_kernel(void)
+{
+    asm("movlb 0");                         // 1  Select bank 0
+    asm("sonar_parallel_wait:");            // Wait for any ECHO to start:
+    asm("movf PORTC,w");                    // 1  Read all ECHO pins
+    asm("andlw " SONAR_STR(SONAR_ECHO_PINS));   // 1
+    asm("btfss STATUS,2");                  // 2  (1 when an ECHO is high)
+    asm("bra sonar_parallel_rise");         //    (2)
+    asm("decfsz " SONAR_K(SONAR_K_WAIT) ",f");  // 1  (2 every 256 passes)
+    asm("bra sonar_parallel_wait");         // 2
+    asm("decfsz " SONAR_K(SONAR_K_WAIT + 1) ",f");
+    asm("bra sonar_parallel_wait");
+    asm("movlw " SONAR_STR(SONAR_NO_SENSOR));   // No ECHO pulses started
+    asm("bra sonar_parallel_end");
+    asm("sonar_parallel_rise:");            // First ECHO started:
+    KERNEL_DELAY(SONAR_K_FIRST);            //    First check delay
+    asm("bra sonar_parallel_check");        // 2
+    asm("sonar_parallel_count:");           // Count range of each module:
+    KERNEL_DELAY(SONAR_K_UNIT);             //    Counting pass delay
+    asm("sonar_parallel_check:");
+    asm("movf PORTC,w");                    // 1  Read all ECHO pins at once
+    asm("andlw " SONAR_STR(SONAR_ECHO_PINS));   // 1
+    asm("movwf " SONAR_K(SONAR_K_ECHO));    // 1
+    asm("iorwf " SONAR_K(SONAR_K_STARTED) ",f");    // 1
+    asm("btfsc " SONAR_K(SONAR_K_ECHO) "," SONAR_STR(PIN_BIT(ECHO_PIN)));   // 2 per module
+    asm("incf " SONAR_K(SONAR_K_RANGES) ",f");
+#if SONAR_SENSORS > 1
+    asm("btfsc " SONAR_K(SONAR_K_ECHO) "," SONAR_STR(PIN_BIT(SONAR2_PIN)));
+    asm("incf " SONAR_K(SONAR_K_RANGES + 1) ",f");
+#endif
+#if SONAR_SENSORS > 2
+    asm("btfsc " SONAR_K(SONAR_K_ECHO) "," SONAR_STR(PIN_BIT(SONAR3_PIN)));
+    asm("incf " SONAR_K(SONAR_K_RANGES + 2) ",f");
+#endif
+    asm("incf " SONAR_K(SONAR_K_RANGE) ",f");   // 1  Count passes
+    asm("movf " SONAR_K(SONAR_K_RANGE) ",w");   // 1
+    asm("xorwf " SONAR_K(SONAR_K_MAX) ",w");    // 1
+    asm("btfsc STATUS,2");                  // 2  Z is set at maximum range
+    asm("bra sonar_parallel_done");
+    asm("movf " SONAR_K(SONAR_K_STARTED) ",w"); // 1  Continue while any ECHO is
+    asm("xorlw " SONAR_STR(SONAR_ECHO_PINS));   // 1  high or hasn't started
+    asm("iorwf " SONAR_K(SONAR_K_ECHO) ",w");   // 1
+    asm("btfss STATUS,2");                  // 1
+    asm("bra sonar_parallel_count");        // 2
+    asm("sonar_parallel_done:");
+    asm("movlw " SONAR_STR(SONAR_OK));
+    asm("sonar_parallel_end:");
+    asm("movwf " SONAR_K(SONAR_K_STATUS));
+}
+#endif
+
+// Parallel SONAR range function - ping all SONAR modules at once and save the
+// range to the closest target of each module in sonarRanges[] in cm.
+void sonar_range_parallel(void)
+{
+    // The SONAR modules cannot be re-triggered until all ECHO pulses end
+    if(ECHOES != 0)
+    {
+        sonarStatus = SONAR_NOT_READY;
+        STATS_INC(notReady);
+        sonarBlockedTicks = 0;
+        return;
+    }
+    
+    // Load the kernel parameters and clear the range counters
+    for(unsigned char i = 0; i != 6; i++)
+    {
+        sonarKernel[SONAR_K_FIRST + i] = sonarParallelParams[i];
+    }
+    sonarKernel[SONAR_K_WAIT] = (unsigned char)SONAR_PARALLEL_LOOPS;
+    sonarKernel[SONAR_K_WAIT + 1] = (unsigned char)((SONAR_PARALLEL_LOOPS - 1) >> 8) + 1;
+    sonarKernel[SONAR_K_MAX] = SONAR_MAX_RANGE;
+    sonarKernel[SONAR_K_RANGE] = 0;
+    sonarKernel[SONAR_K_STARTED] = 0;
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        sonarKernel[SONAR_K_RANGES + i] = 0;
+    }
+    
+    // Make TRIGger pulse on all TRIG pins, and count all ECHO pulses
+    // while Timer1 times the interrupts-off window for sonarBlockedTicks
+    bool interrupts = GIE;
+    GIE = 0;
+    TMR1H = 0;
+    TMR1L = 0;
+    LATC = LATC | SONAR_TRIG_PINS;
+    SONAR_DELAY_US(20);
+    LATC = LATC & ~SONAR_TRIG_PINS;
+    sonar_parallel_kernel();
+    sonarBlockedTicks = TMR1;
+    GIE = interrupts;
+    if(sonarKernel[SONAR_K_STATUS] == SONAR_NO_SENSOR)
+    {
+        sonarStatus = SONAR_NO_SENSOR;  // No ECHO pulses - SONAR modules missing?
+        SONAR_PARALLEL_STATS();
+        return;
+    }
+    
+    // Save ranges, ignoring modules with ECHO pulses still active at max range
+    unsigned char echo = sonarKernel[SONAR_K_ECHO];
+    sonarStatus = SONAR_OK;
+    if(echo != 0 || sonarKernel[SONAR_K_STARTED] != SONAR_ECHO_PINS)
+    {
+        sonarStatus = SONAR_NO_ECHO;
+    }
+    sonarRanges[0] = (echo & SONAR1_ECHO) ? 0 : sonarKernel[SONAR_K_RANGES];
+#if SONAR_SENSORS > 1
+    sonarRanges[1] = (echo & SONAR2_ECHO) ? 0 : sonarKernel[SONAR_K_RANGES + 1];
+#endif
+#if SONAR_SENSORS > 2
+    sonarRanges[2] = (echo & SONAR3_ECHO) ? 0 : sonarKernel[SONAR_K_RANGES + 2];
+#endif
+    sonarUpdated = (1 << SONAR_SENSORS) - 1;
+    SONAR_PARALLEL_STATS();
+}
+#endif
+
+// Configure TRIG output, Timer1 and ECHO interrupt for SONAR measurements.
+void sonar_config(void)
+{
+    TRIG = 0;
+    PIN_TRIS(TRIG_PIN) = 0;     // Set TRIG as output pin
+    PIN_TRIS(ECHO_PIN) = 1;     // Set ECHO as input pin
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+    LATC = LATC & ~SONAR_TRIG_PINS;
+    TRISC = TRISC & ~SONAR_TRIG_PINS;   // Set all scanner TRIG pins as outputs
+#endif
+#ifdef SONAR_PARALLEL
+    TRISC = TRISC | SONAR_ECHO_PINS;    // Set all parallel ECHO pins as inputs
+#endif
+
+    T1CON = 0b00110000;         // Timer1 off, FOSC/4 clock, 1:8 prescaler
+    T1GCON = 0b00000000;        // Disable Timer1 gate (count continuously)
+
+    TMR1H = 0;                  // Start SONAR module recovery time
+    TMR1L = 0;
+    TMR1IF = 0;
+    TMR1ON = 1;
+
+    INTE = 0;                   // Keep ECHO interrupt off until sonar_start()
+    TMR1IE = 0;                 // Keep Timer1 interrupt off until sonar_start()
+    PEIE = 1;                   // Enable peripheral (Timer1) interrupts
+    GIE = 1;                    // Enable global interrupts
+}
+
+// Arm Timer1 and the ECHO interrupt to capture the next ECHO pulse without
+// triggering the SONAR module - returns false if the module is not ready.
+bool sonar_arm(void)
+{
+    // The SONAR module cannot be re-triggered until the last ECHO pulse ends
+    if(sonarBusy || ECHO == 1)
+    {
+        if(!sonarBusy)
+        {
+            sonarStatus = SONAR_NOT_READY;
+            STATS_INC(notReady);
+        }
+        return(false);
+    }
+    sonarBusy = true;
+    sonarDone = false;
+#ifdef SONAR_MULTI_ECHO
+    sonarEdgeCount = 0;
+    sonarCapturing = false;
+    sonarBlanked = false;
+#endif
+
+    // Preload and start Timer1 to time out if the ECHO pulse never starts
+    TMR1ON = 0;
+    TMR1H = (unsigned char)((0 - SONAR_START_TICKS) >> 8);
+    TMR1L = (unsigned char)(0 - SONAR_START_TICKS);
+    TMR1IF = 0;
+    TMR1IE = 1;
+    TMR1ON = 1;
+
+    // Arm ECHO interrupt for the rising edge at the start of the ECHO pulse
+    INTEDG = 1;
+    INTF = 0;
+    INTE = 1;
+
+    return(true);
+}
+
+// Arm the ECHO capture and pulse the TRIG pin(s) in trigPins to start a new
+// measurement - returns false if the module is not ready.
+static bool sonar_ping(unsigned char trigPins)
+{
+    if(!sonar_arm())
+    {
+        return(false);
+    }
+
+    // Make TRIGger pulse (10us minimum) to start a new measurement
+    LATC = LATC | trigPins;
+    SONAR_DELAY_US(10);
+    LATC = LATC & ~trigPins;
+    STATS_INC(pings);
+
+    return(true);
+}
+
+// SONAR ready function - check and return SONAR state (ready == 1). Since the
+// SONAR module can't be re-triggered until ECHO goes low and the module has
+// recovered, Timer1 times the recovery period after each ECHO pulse ends.
+bool sonar_ready(void)
+{
+    if(sonarBusy || ECHO == 1)
+    {
+        return(false);          // Not ready - SONAR receive in progress
+    }
+    
+    // Compare only TMR1H, since it can't change part-way through being read.
+    // TMR1IF is set if Timer1 has overflowed during a long recovery period.
+    if(!TMR1IF && TMR1H < (SONAR_RECOVERY_TICKS >> 8))
+    {
+        return(false);          // Not ready - SONAR module recovering
+    }
+    return(true);               // SONAR ready
+}
+
+// Abandon the measurement in progress (e.g. an ECHO pulse that never ends).
+// An unfinished measurement finishes with SONAR_NO_ECHO, and Timer1 restarts
+// to time the recovery period.
+void sonar_cancel(void)
+{
+    INTE = 0;                   // Stop the ECHO and Timer1 interrupts first
+    TMR1IE = 0;
+    sonarDraining = false;
+#ifdef SONAR_MULTI_ECHO
+    sonarCapturing = false;
+#endif
+    if(sonarBusy && !sonarDone)
+    {
+        sonarPulse = 0;
+        sonarStatus = SONAR_NO_ECHO;
+        sonarDone = true;
+    }
+    TMR1ON = 0;                 // Restart Timer1 to time recovery period
+    TMR1H = 0;
+    TMR1L = 0;
+    TMR1IF = 0;
+    TMR1ON = 1;
+    sonarBusy = false;
+}
+
+// Start a new SONAR measurement - returns false if the module is not ready.
+bool sonar_start(void)
+{
+    return(sonar_ping(SONAR1_TRIG));
+}
+
+// Set the maximum range of interrupt-driven measurements in cm. ECHO pulses
+// longer than maxRange are reported as soon as their length reaches maxRange.
+// maxRange is kept beyond the blanking window so the blanking preload can't
+// wrap past the Timer1 overflow, and the ECHO and Timer1 interrupts are held
+// off while the 16-bit preloads are written so the handlers can't read a
+// half-written value.
+void sonar_max_range(unsigned char maxRange)
+{
+    if(maxRange <= SONAR_MIN_RANGE)
+    {
+        maxRange = SONAR_MIN_RANGE + 1;
+    }
+    uint16_t echoStart = 0 - (maxRange * SONAR_TICKS_PER_CM);
+    bool echoInt = INTE;
+    bool timerInt = TMR1IE;
+    
+    INTE = 0;
+    TMR1IE = 0;
+    sonarEchoStart = echoStart;
+    sonarEchoBase = echoStart - SONAR_OFFSET_TICKS;     // Round to nearest cm
+    sonarEchoBlank = echoStart + SONAR_BLANK_TICKS;     // End of blanking
+    INTE = echoInt;
+    TMR1IE = timerInt;
+}
+
+// Convert a pulse length in microseconds to cm without dividing. Multiplies by
+// the reciprocal of 58 (us / 58 = us * 1130 / 65536) one bit of 1130 at a time
+// (0b10001101010), shifting the 16-bit sum right between bits so it never
+// overflows. The result is exact (the same as us / 58) for every valid input.
+unsigned char sonar_us_to_cm(unsigned int us)
+{
+    if(us >= 255 * 58)          // Prevent range from overflowing
+    {
+        return(255);
+    }
+    unsigned int cm = us;       // Bit 1
+    cm = (cm >> 2) + us;        // Bit 3
+    cm = (cm >> 2) + us;        // Bit 5
+    cm = (cm >> 1) + us;        // Bit 6
+    cm = (cm >> 4) + us;        // Bit 10
+    return((unsigned char)(cm >> 6));
+}
+
+// Convert a pulse length in Timer1 ticks to cm without dividing, using the
+// reciprocal of 87 (ticks / 87 = ticks * 12053 / 1048576) in the same way as
+// sonar_us_to_cm() above (12053 = 0b10111100010101). The result is exact.
+unsigned char sonar_ticks_to_cm(unsigned int ticks)
+{
+    if(ticks >= 255 * SONAR_TICKS_PER_CM)   // Prevent range from overflowing
+    {
+        return(255);
+    }
+    unsigned int cm = ticks;    // Bit 0
+    cm = (cm >> 2) + ticks;     // Bit 2
+    cm = (cm >> 2) + ticks;     // Bit 4
+    cm = (cm >> 4) + ticks;     // Bit 8
+    cm = (cm >> 1) + ticks;     // Bit 9
+    cm = (cm >> 1) + ticks;     // Bit 10
+    cm = (cm >> 1) + ticks;     // Bit 11
+    cm = (cm >> 2) + ticks;     // Bit 13
+    return((unsigned char)(cm >> 7));
+}
+
+#ifdef STATS
+// Count the result of an interrupt-driven measurement when it is read. The
+// interrupt handlers only save each result, so that every stats counter is
+// written by the main program alone.
+static void sonar_read_stats(void)
+{
+    STATS_ADD(waitCycles, (unsigned long)sonarWaitTicks << 3);
+    if(sonarStatus == SONAR_OK)
+    {
+        STATS_INC(echoes);
+        STATS_ADD(countCycles, (unsigned long)sonarPulse << 3);
+    }
+    else if(sonarStatus == SONAR_NO_SENSOR)
+    {
+        STATS_INC(noSensor);
+    }
+    else if(sonarStatus == SONAR_BLANKED)
+    {
+        STATS_INC(blanked);
+    }
+    else if(sonarStatus == SONAR_NO_ECHO)
+    {
+        STATS_INC(noEcho);
+        STATS_ADD(countCycles, (unsigned long)(uint16_t)(0 - sonarEchoStart) << 3);
+    }
+}
+#define SONAR_READ_STATS()  sonar_read_stats()
+#else
+#define SONAR_READ_STATS()
+#endif
+
+// Return range (or 0 if no ECHO) from the last completed measurement in cm.
+#ifdef SONAR_TEMP_COMP
+// The pulse is corrected for the temperature band's speed of sound by adding
+// or subtracting each shifted correction term, and then converted to cm.
+unsigned char sonar_read(void)
+{
+    sonarDone = false;
+    SONAR_READ_STATS();
+    unsigned int pulse = sonarPulse;
+    unsigned int ticks = pulse;
+    for(unsigned char i = 0; i != SONAR_TEMP_TERMS; i++)
+    {
+        signed char shift = sonarTempShifts[i];
+        if(shift > 0)
+        {
+            ticks += pulse >> shift;
+        }
+        else if(shift < 0)
+        {
+            ticks -= pulse >> -shift;
+        }
+    }
+    return(sonar_ticks_to_cm(ticks));
+}
+
+// Configure the ADC for the temperature indicator, leaving the PORTC pins unchanged.
+void sonar_temp_config(void)
+{
+    FVRCON = FVRCON | 0b00110000;   // Enable temperature indicator, high range
+    ADCON0 = 0b00000000;        // Leave A/D converter off
+    ADCON1 = 0b01100000;        // Left justified result, FOSC/64 clock, +VDD ref
+    ADCON2 = 0b00000000;        // Auto-conversion trigger disabled
+}
+
+// Read the temperature indicator, select the matching temperature band, and
+// split its pulse correction into the nearest power-of-two terms.
+void sonar_temp_update(void)
+{
+    if(ADIE)                    // ADC in use by an ADC_burst_start() burst
+    {
+        return;
+    }
+    ADC_select_channel(ANTIM);
+    SONAR_DELAY_US(SONAR_TEMP_ACQ_TIME);    // Allow temperature indicator to settle
+    GO = 1;
+    while(GO)
+        ;
+    ADON = 0;
+    sonarTempReading = ((unsigned int)ADRESH << 2) | (ADRESL >> 6);
+    
+    // Find the temperature band, and set the compensation values
+    unsigned char band = 0;
+    while(band != SONAR_TEMP_BANDS - 1 && sonarTempReading > sonarTempLimit[band])
+    {
+        band ++;
+    }
+    sonarTempBand = band;
+    int scale = sonarTempScales[band];
+    for(unsigned char i = 0; i != SONAR_TEMP_TERMS; i++)
+    {
+        sonarTempShifts[i] = 0;
+        unsigned int size = (scale < 0) ? (unsigned int)-scale : (unsigned int)scale;
+        if(size < 2)            // Remaining correction is below 1/32768
+        {
+            continue;
+        }
+        unsigned int term = 0x4000;     // Largest term (1/4)
+        signed char shift = 2;
+        while(term > 2 && size < term - (term >> 2))
+        {
+            term >>= 1;         // Find the nearest power of two
+            shift ++;
+        }
+        if(scale < 0)
+        {
+            sonarTempShifts[i] = -shift;
+            scale += (int)term;
+        }
+        else
+        {
+            sonarTempShifts[i] = shift;
+            scale -= (int)term;
+        }
+    }
+}
+#else
+unsigned char sonar_read(void)
+{
+    sonarDone = false;
+    SONAR_READ_STATS();
+    return(sonar_ticks_to_cm(sonarPulse));
+}
+#endif
+
+#ifdef SONAR_SCAN
+// Multi-sensor SONAR scanner - call every 1ms to ping each module in turn.
+void sonar_scan(void)
+{
+    if(sonarBusy)               // Wait for the ping in flight to finish
+    {
+        return;
+    }
+    
+    // Save the completed measurement and select the next SONAR module
+    if(sonarDone)
+    {
+        sonarRanges[sonarSensor] = sonar_read();
+        sonarUpdated = sonarUpdated | (unsigned char)(1 << sonarSensor);
+        sonarSensor ++;
+        if(sonarSensor == SONAR_SENSORS)
+        {
+            sonarSensor = 0;
+        }
+        sonarGuard = SONAR_GUARD_TIME;
+    }
+    
+    // Ping the next module once the echoes of the last ping have faded
+    if(sonarGuard != 0)
+    {
+        sonarGuard --;
+        return;
+    }
+    sonar_ping(sonarTrigPins[sonarSensor]);
+}
+#endif
+
+#ifdef SONAR_MULTI_ECHO
+// Finish a multi-echo capture when the edge buffer is full or the maximum
+// range is reached. If the ECHO pulse is still active, leave the ECHO
+// interrupt on to drain it, as for single echo measurements.
+static void sonar_capture_end(void)
+{
+    sonarCapturing = false;
+    TMR1IE = 0;
+    sonarPulse = (sonarEdgeCount != 0) ? sonarEdges[0] : 0;   // First return
+    sonarStatus = SONAR_OK;
+    if(sonarEdgeCount == 0)     // No returns - only blanked pulses, or none
+    {
+        sonarStatus = sonarBlanked ? SONAR_BLANKED : SONAR_NO_ECHO;
+    }
+    sonarDone = true;
+    if(ECHO == 1)               // Wait for ECHO pulse to end
+    {
+        sonarDraining = true;
+        INTEDG = 0;
+        return;
+    }
+    INTE = 0;                   // Restart Timer1 to time recovery period
+    TMR1ON = 0;
+    TMR1H = 0;
+    TMR1L = 0;
+    TMR1IF = 0;
+    TMR1ON = 1;
+    sonarBusy = false;
+}
+
+// SONAR multi-echo ECHO interrupt handler - the first rising edge starts
+// Timer1 from the maximum range preload, and the time of every following ECHO
+// edge is saved in sonarEdges[] (including the start offset). Timer1 is
+// stopped while it is read, losing less than one tick per edge. An ECHO pulse
+// that ends inside the blanking window is discarded with the rising edge that
+// follows it, so that falling edges (returns) stay in the even entries.
+void sonar_echo_isr(void)
+{
+    TMR1ON = 0;
+    uint16_t time = TMR1;
+    if(!sonarDraining && !sonarCapturing)   // ECHO started - start capture
+    {
+#ifdef STATS
+        sonarWaitTicks = time + SONAR_START_TICKS;  // Ticks since arm
+#endif
+        TMR1H = (unsigned char)(sonarEchoStart >> 8);
+        TMR1L = (unsigned char)sonarEchoStart;
+        TMR1IF = 0;
+        TMR1ON = 1;
+        sonarCapturing = true;
+        INTEDG = 0;             // Next interrupt on falling edge
+        return;
+    }
+    TMR1ON = 1;
+    if(sonarDraining)           // Falling edge - last ECHO pulse ended
+    {
+        sonarDraining = false;
+        INTE = 0;
+        TMR1ON = 0;             // Restart Timer1 to time recovery period
+        TMR1H = 0;
+        TMR1L = 0;
+        TMR1IF = 0;
+        TMR1ON = 1;
+        sonarBusy = false;
+        return;
+    }
+    bool rising = INTEDG;
+    INTEDG = !INTEDG;           // Next interrupt on the opposite edge
+    if((sonarEdgeCount & 1) == 0)   // Waiting for a return (falling edge)
+    {
+        if(rising)              // Rising edge after a blanked ECHO pulse
+        {
+            return;
+        }
+        if(time < sonarEchoBlank)   // ECHO ended inside blanking window
+        {
+            sonarBlanked = true;
+            return;
+        }
+    }
+    sonarEdges[sonarEdgeCount] = time - sonarEchoBase;
+    sonarEdgeCount ++;
+    if(sonarEdgeCount == SONAR_EDGES)
+    {
+        sonar_capture_end();
+    }
+}
+
+// SONAR multi-echo Timer1 interrupt handler - the ECHO pulse did not start, or
+// the capture has reached the maximum range.
+void sonar_timer_isr(void)
+{
+    TMR1IE = 0;
+    if(!sonarCapturing)         // ECHO pulse never started - no SONAR module?
+    {
+        sonarStatus = SONAR_NO_SENSOR;
+        INTE = 0;
+        sonarBusy = false;      // Timer1 keeps running to time recovery period
+        sonarPulse = 0;
+        sonarDone = true;
+#ifdef STATS
+        sonarWaitTicks = SONAR_START_TICKS;
+#endif
+        return;
+    }
+    sonar_capture_end();
+}
+
+// Return the number of ECHO returns recorded by the last measurement.
+unsigned char sonar_echo_count(void)
+{
+    return((sonarEdgeCount + 1) >> 1);
+}
+
+// Return the range of ECHO return n (the time of its falling edge) in cm.
+unsigned char sonar_echo_range(unsigned char n)
+{
+    n = n << 1;                 // Falling edges are even sonarEdges[] entries
+    if(n >= sonarEdgeCount)
+    {
+        return(0);
+    }
+    return(sonar_ticks_to_cm(sonarEdges[n]));
+}
+#else
+// SONAR ECHO interrupt handler - time ECHO pulse using INT pin edges and
+// Timer1. Timer1 is preloaded at the start of the ECHO pulse so that it
+// overflows when the ECHO pulse reaches the maximum range. Beyond-range
+// measurements finish immediately (in sonar_timer_isr()), and the ECHO
+// interrupt then drains the rest of the ECHO pulse in the background by
+// clearing sonarBusy when the pulse finally ends.
+void sonar_echo_isr(void)
+{
+    if(INTEDG)                  // Rising edge - ECHO pulse started
+    {
+        TMR1ON = 0;             // Preload Timer1 to overflow at maximum range
+#ifdef STATS
+        sonarWaitTicks = TMR1 + SONAR_START_TICKS;  // Ticks since arm
+#endif
+        TMR1H = (unsigned char)(sonarEchoStart >> 8);
+        TMR1L = (unsigned char)sonarEchoStart;
+        TMR1IF = 0;
+        TMR1ON = 1;
+        INTEDG = 0;             // Next interrupt on falling edge
+    }
+    else                        // Falling edge - ECHO pulse ended
+    {
+        TMR1ON = 0;
+        if(!sonarDraining)      // Save ECHO pulse length if within range
+        {
+            if(TMR1 < sonarEchoBlank)   // ECHO ended inside blanking window
+            {
+                sonarPulse = 0;
+                sonarStatus = SONAR_BLANKED;
+            }
+            else                // Save pulse length including start offset
+            {
+                sonarPulse = TMR1 - sonarEchoBase;
+                sonarStatus = SONAR_OK;
+            }
+            sonarDone = true;
+        }
+        sonarDraining = false;
+        INTE = 0;
+        TMR1IE = 0;
+        TMR1H = 0;              // Restart Timer1 to time recovery period
+        TMR1L = 0;
+        TMR1IF = 0;
+        TMR1ON = 1;
+        sonarBusy = false;
+    }
+}
+
+// SONAR Timer1 interrupt handler - Timer1 overflow means that the ECHO pulse
+// did not start, or that it has reached the maximum range.
+void sonar_timer_isr(void)
+{
+    TMR1IE = 0;
+    if(INTEDG)                  // ECHO pulse never started - no SONAR module?
+    {
+        sonarStatus = SONAR_NO_SENSOR;
+        INTE = 0;
+        sonarBusy = false;      // Timer1 keeps running to time recovery period
+#ifdef STATS
+        sonarWaitTicks = SONAR_START_TICKS;
+#endif
+    }
+    else                        // ECHO pulse still active - no target in range
+    {
+        sonarStatus = SONAR_NO_ECHO;
+        sonarDraining = true;   // Leave ECHO interrupt on until pulse ends
+    }
+    sonarPulse = 0;             // Report no target (range 0)
+    sonarDone = true;
+}
+#endif
@@ -0,0 +1,596 @@
+/*==============================================================================
+ File: SONAR.h
+ Date: October 14, 2026
+
+ HC-SR04 SONAR module symbolic constant and function definitions.
+
+ SONAR module I/O pin definitions section:
+ Assigns the TRIG and ECHO names to the UBMP4 header pins wired to the SONAR
+ module using the pin descriptors in UBMP420.h. ECHO must remain on H2 (RC1)
+ to use the interrupt-driven measurement functions, since RC1 is also the
+ PIC16F1459 external interrupt (INT) input.
+ Defining SONAR_HOST replaces the pins and delays with host program functions.
+
+ SONAR scanner definitions section:
+ Assigns the TRIG pins of each SONAR module used by the multi-sensor scanner.
+
+ SONAR timing definitions section:
+ Timer1 tick rate and distance unit constants used by the SONAR functions.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the SONAR.c file.
+==============================================================================*/
+
+// SONAR module I/O pin definitions and delay functions. TRIG_PIN and ECHO_PIN
+// are UBMP420.h pin descriptors (header pins on PORTC), and sonar_config()
+// sets their TRIS bits, so changing a descriptor moves the pin everywhere.
+// Define SONAR_HOST in the compiler macros of a host (PC) build of SONAR.c
+// (using the host/xc.h register stub, which declares the PIC16F1459 registers
+// as variables) to run the range functions against a simulated SONAR module,
+// as the host/HOST.c scenarios run by 'make host-test' do.
+// The host program then supplies the sonar_host_echo() function, which returns
+// the simulated ECHO pin state at the current simulated time, and the
+// sonar_host_delay() function, which advances the simulated time by the
+// requested number of instruction cycles. Host builds replace the assembly
+// language counting kernel with a C model that checks ECHO and requests
+// delays at the same instruction cycles as the kernel.
+// sonar_host_delay() can check sonarHostTrig to detect the TRIG pulse, and
+// sonar_host_echoes() returns all simulated ECHO pins (SONAR_ECHO_PINS bits).
+#ifdef SONAR_HOST
+extern unsigned char sonarHostTrig; // Simulated TRIG output (host program)
+#define TRIG        sonarHostTrig   // SONAR TRIG(ger) output (simulated)
+#define ECHO        sonar_host_echo()   // SONAR ECHO input (simulated)
+#define ECHOES      sonar_host_echoes() // All ECHO inputs (simulated PORTC bits)
+#define SONAR_DELAY(cycles)     sonar_host_delay(cycles)
+#define SONAR_DELAY_US(time)    sonar_host_delay((time) * (_XTAL_FREQ / 4000000))
+unsigned char sonar_host_echo(void);
+unsigned char sonar_host_echoes(void);
+void sonar_host_delay(unsigned long);
+#else
+#define TRIG        PIN_LAT(TRIG_PIN)   // SONAR TRIG(ger) output
+#define ECHO        PIN_IN(ECHO_PIN)    // SONAR ECHO input
+#define ECHOES      (PORTC & SONAR_ECHO_PINS)   // All SONAR ECHO inputs
+#define SONAR_DELAY(cycles)     _delay(cycles)      // Delay (instruction cycles)
+#define SONAR_DELAY_US(time)    __delay_us(time)    // Delay (us)
+#endif
+#define TRIG_PIN    H1_PIN          // SONAR TRIG(ger) output on H1 (PORTC)
+#define ECHO_PIN    H2_PIN          // SONAR ECHO input on H2 (must be INT/RC1)
+#if PIN_PORT(ECHO_PIN) != PIN_PORT_C || PIN_BIT(ECHO_PIN) != 1
+#error "ECHO_PIN must be H2 (RC1), the INT input used by the SONAR interrupts"
+#endif
+#if PIN_PORT(TRIG_PIN) != PIN_PORT_C
+#error "TRIG_PIN must be a PORTC pin, since sonar_ping() pulses its mask in LATC"
+#endif
+#define SONAR1_TRIG PIN_MASK(TRIG_PIN)  // SONAR TRIG pin mask (LATC)
+
+// SONAR scanner definitions. Un-comment SONAR_SCAN to enable the sonar_scan()
+// function, which pings up to four SONAR modules in turn. Each module has its
+// own TRIG pin, and the ECHO outputs of all modules are combined onto H2 using
+// one diode per module (anodes to each ECHO pin, cathodes to H2) and a 10k
+// pull-down resistor from H2 to ground. Only one module is pinged at a time,
+// and the next module is not pinged until SONAR_GUARD_TIME has passed after
+// the last ECHO pulse ends, to allow any echoes of the previous ping to fade.
+//
+// Un-comment SONAR_PARALLEL to enable the sonar_range_parallel() function
+// instead, which pings all of the SONAR modules at the same time and times
+// every ECHO pulse in a single pass. Connect each module's ECHO output to its
+// own PORTC header pin (SONARn_PIN), and TRIG of all modules to H1. The
+// scanner and parallel pins are used as bit masks in LATC and PORTC, so they
+// must all be PORTC header pins. sonar_range_parallel() runs with interrupts
+// disabled until every ECHO pulse ends, so SONAR_PARALLEL can't be used with
+// the interrupt-driven I2C_SLAVE register map (see CONFIG.h).
+// #define SONAR_SCAN                  // Enable multi-sensor scanner
+// #define SONAR_PARALLEL              // Enable parallel multi-sensor ranging
+#define SONAR_SENSORS       3           // Number of SONAR modules (1-4)
+#define SONAR2_PIN          H3_PIN      // SONAR 2 TRIG (scanner) or ECHO (parallel)
+#define SONAR3_PIN          H4_PIN      // SONAR 3 TRIG (scanner) or ECHO (parallel)
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+#if PIN_PORT(SONAR2_PIN) != PIN_PORT_C || PIN_PORT(SONAR3_PIN) != PIN_PORT_C
+#error "SONAR2_PIN and SONAR3_PIN must be PORTC pins (LATC and PORTC masks)"
+#endif
+#endif
+#ifdef SONAR_PARALLEL
+#define SONAR2_TRIG         PIN_MASK(TRIG_PIN)  // SONAR 2 TRIG pin mask (H1)
+#define SONAR3_TRIG         PIN_MASK(TRIG_PIN)  // SONAR 3 TRIG pin mask (H1)
+#define SONAR4_TRIG         PIN_MASK(TRIG_PIN)  // SONAR 4 TRIG pin mask (H1)
+#else
+#define SONAR2_TRIG         PIN_MASK(SONAR2_PIN)    // SONAR 2 TRIG pin mask (H3)
+#define SONAR3_TRIG         PIN_MASK(SONAR3_PIN)    // SONAR 3 TRIG pin mask (H4)
+#define SONAR4_TRIG         0b00000000  // SONAR 4 TRIG pin mask (unused)
+#endif
+#define SONAR_TRIG_PINS     (SONAR1_TRIG | SONAR2_TRIG | SONAR3_TRIG | SONAR4_TRIG)
+#define SONAR1_ECHO         PIN_MASK(ECHO_PIN)  // SONAR 1 ECHO pin mask (H2)
+#define SONAR2_ECHO         PIN_MASK(SONAR2_PIN)    // SONAR 2 ECHO pin mask (H3)
+#define SONAR3_ECHO         PIN_MASK(SONAR3_PIN)    // SONAR 3 ECHO pin mask (H4)
+#define SONAR4_ECHO         0           // SONAR 4 ECHO pin mask (unused)
+#define SONAR_ECHO_PINS     (SONAR1_ECHO | SONAR2_ECHO | SONAR3_ECHO | SONAR4_ECHO)
+#if defined(SONAR_PARALLEL) && SONAR_SENSORS > 3
+#error "SONAR_PARALLEL supports up to 3 SONAR modules (ECHO on H2-H4)"
+#endif
+#if defined(SONAR_PARALLEL) && defined(I2C_SLAVE)
+#error "SONAR_PARALLEL disables interrupts for up to 17ms per ping, stalling the I2C slave - use SONAR_SCAN"
+#endif
+#define SONAR_GUARD_TIME    25          // Crosstalk guard time between pings (ms)
+
+// SONAR multi-echo capture definitions. Un-comment SONAR_MULTI_ECHO to make
+// the interrupt-driven measurement functions record the time of up to
+// SONAR_EDGES ECHO edges after the ECHO pulse starts, within the maximum
+// range, for SONAR modules that report more than one echo per ping as a
+// series of ECHO pulses. The falling edge of each ECHO pulse marks an echo
+// (return), so an odd number of edges records (SONAR_EDGES + 1) / 2 returns.
+// sonar_read() returns the range of the first return, and sonar_echo_range()
+// returns the range of each return (e.g. the first and last returns can
+// distinguish a small, close target from a far wall using a single ping).
+// ECHO pulses that end inside the blanking window are discarded, and a
+// measurement with no other returns sets sonarStatus to SONAR_BLANKED.
+// #define SONAR_MULTI_ECHO             // Record multiple ECHO returns per ping
+#define SONAR_EDGES         7           // ECHO edge buffer size (odd, edges)
+
+// SONAR range unit definitions. The range functions below count distance
+// units directly by timing the ECHO pulse in steps equal to the round-trip
+// sound travel time of one unit. Un-comment the definitions of the range
+// functions used by the program, and set sonar_range() to the range function
+// that should be used by default. Unused range functions are not compiled.
+#define SONAR_RANGE_CM                  // sonar_range_cm() - 1cm units
+// #define SONAR_RANGE_HCM              // sonar_range_hcm() - 0.5cm units
+// #define SONAR_RANGE_MM2              // sonar_range_mm2() - 2mm units
+// #define SONAR_RANGE_IN               // sonar_range_in() - 1 inch units
+#define sonar_range sonar_range_cm      // Default range function
+
+// Round-trip sound travel times of each range unit in tenths of microseconds.
+#define SONAR_CM_TIME       580         // 1cm (58.0us)
+#define SONAR_HCM_TIME      290         // 0.5cm (29.0us)
+#define SONAR_MM2_TIME      116         // 2mm (11.6us)
+#define SONAR_IN_TIME       1480        // 1 inch (148.0us)
+
+// SONAR timing definitions. SONAR_UNIT_CYCLES() converts a unit's round-trip
+// time into the number of instruction cycles at _XTAL_FREQ at compile time.
+// The range functions count units in the hand-written assembly counting
+// kernel in SONAR.c (sonar_kernel()), so their timing doesn't depend on the
+// compiler or its optimization level. The cycles of every kernel instruction
+// are listed in its comments: SONAR_COUNT_CYCLES are the cycles used by each
+// counting pass besides its delay, and SONAR_BLANK_SKIP the cycles between
+// the blanking check and the first count delay. Interrupts are disabled while
+// the kernel runs, so interrupt handlers can't lengthen a pass. The benchmark
+// program (BENCH.c) measures the kernel's pass lengths on the target.
+#define SONAR_UNIT_CYCLES(time) ((time) * (_XTAL_FREQ / 4000000) / 10)
+#define SONAR_COUNT_CYCLES  8           // Counting pass cycles besides its delay
+#define SONAR_BLANK_SKIP    2           // Blanking check cycles (ECHO still high)
+
+// SONAR kernel delay definitions. Each kernel delay is set by three delay
+// parameters calculated at compile time: an inner loop count l (3 cycles per
+// pass, 0 means 256), an outer loop count h (770 cycles for each pass after
+// the first), and a padding mask with one bit set for each of 0-4 extra
+// cycles, producing delays of exactly 12 + 3l + 770(h - 1) + p cycles for any
+// delay of 15 or more cycles (up to 196k cycles).
+#define SONAR_DELAY_Q(d)    (((d) - 15) / 770)
+#define SONAR_DELAY_R(d)    ((d) - 12 - 770 * SONAR_DELAY_Q(d))
+#define SONAR_DELAY_L(d)    (SONAR_DELAY_R(d) > 770 ? 256 : SONAR_DELAY_R(d) / 3)
+#define SONAR_DELAY_P(d)    (SONAR_DELAY_R(d) - 3 * SONAR_DELAY_L(d))
+#define SONAR_DELAY_PARAMS(d)   (unsigned char)SONAR_DELAY_L(d), \
+    (unsigned char)(SONAR_DELAY_Q(d) + 1), (unsigned char)((1 << SONAR_DELAY_P(d)) - 1)
+
+// SONAR kernel variables. The counting kernel's parameters and results are
+// kept in bank 0 (with PORTC) at SONAR_KERNEL_ADDRESS, so the kernel never
+// switches banks. Each range function copies its range unit's parameters
+// (SONAR_PARAMS_SIZE bytes: the blanking, first count and counting pass
+// delays, followed by the first count) into the kernel variables.
+#define SONAR_KERNEL_ADDRESS 0x020      // Kernel variables address (bank 0)
+#define SONAR_K_RANGE       0           // Range count (result)
+#define SONAR_K_STATUS      1           // Kernel result (sonarStatus value)
+#define SONAR_K_WAIT        2           // ECHO start wait passes (low, high byte)
+#define SONAR_K_BLANK       4           // Blanking delay parameters
+#define SONAR_K_FIRST       7           // First count check delay parameters
+#define SONAR_K_UNIT        10          // Counting pass delay parameters
+#define SONAR_K_MAX         13          // Maximum range (units)
+#define SONAR_K_OUTER       14          // Delay outer loop counter
+#define SONAR_K_ECHO        15          // ECHO pins read (parallel kernel)
+#define SONAR_K_STARTED     16          // ECHO pins started (parallel kernel)
+#define SONAR_K_RANGES      17          // Range of each module (parallel kernel)
+#define SONAR_KERNEL_SIZE   20          // Kernel variables size (bytes)
+#define SONAR_PARAMS_SIZE   10          // Range unit parameters size (bytes)
+
+// Timer1 is clocked from FOSC/4 through a 1:8 prescaler, making each Timer1
+// tick 2/3us long (1.5MHz). A 58us round-trip (1cm) SONAR pulse is exactly 87
+// Timer1 ticks long. Timer1 is preloaded so that it overflows when the ECHO
+// pulse reaches the maximum range, or if the ECHO pulse does not start within
+// SONAR_START_TIMEOUT, ending beyond-range measurements early.
+#define SONAR_TMR1_FREQ     (_XTAL_FREQ / 4 / 8)    // Timer1 tick rate (Hz)
+#define SONAR_TICKS_PER_CM  ((unsigned int)(SONAR_TMR1_FREQ * SONAR_CM_TIME / 10000000))
+
+// SONAR blanking and start offset definitions. ECHO pulses shorter than
+// SONAR_BLANK_TIME (caused by transmit ring-down, or targets closer than the
+// SONAR module can measure) are rejected by both measurement engines, setting
+// sonarStatus to SONAR_BLANKED. The range functions wait out the blanking
+// window in one delay and check ECHO exactly SONAR_BLANK_TIME after the ECHO
+// rising edge (less the average SONAR_START_LATENCY cycles taken to detect
+// it), instead of counting the units inside the window. Counting then checks
+// ECHO half a unit past each unit boundary, starting from the first check
+// after the blanking window (SONAR_FIRST_UNIT), so that every range is
+// rounded to the nearest unit instead of being rounded up. Interrupt-driven
+// measurements compare the captured pulse length to the same SONAR_BLANK_TIME,
+// and apply the same half cm offset to the captured pulse length.
+#define SONAR_BLANK_TIME    1160        // Blanking window (tenths of us, 2cm)
+#define SONAR_START_LATENCY (SONAR_RISE_CYCLES + SONAR_WAIT_CYCLES / 2) // ECHO start detection cycles
+#define SONAR_BLANK_CYCLES  SONAR_UNIT_CYCLES(SONAR_BLANK_TIME) // Blanking window (cycles)
+#define SONAR_FIRST_UNIT(time)  SONAR_FIRST_COUNT(SONAR_UNIT_CYCLES(time), SONAR_BLANK_CYCLES)
+#define SONAR_FIRST_CYCLES(time) SONAR_FIRST_DELAY(SONAR_UNIT_CYCLES(time), SONAR_BLANK_CYCLES)
+#define SONAR_MIN_RANGE     SONAR_FIRST_UNIT(SONAR_CM_TIME) // Shortest range measured (cm)
+
+// First count after a blanking window of b cycles using units of u cycles, and
+// the cycles from the blanking check to its count check (half a unit past it).
+#define SONAR_FIRST_COUNT(u, b) ((2 * (b) - (u)) / (2 * (u)) + 1)
+#define SONAR_FIRST_DELAY(u, b) ((u) / 2 + SONAR_FIRST_COUNT(u, b) * (u) - (b))
+
+// Kernel parameters (SONAR_PARAMS_SIZE bytes) for units of u cycles with a
+// blanking window of b cycles.
+#define SONAR_PARAMS(u, b)  {SONAR_DELAY_PARAMS((b) - SONAR_START_LATENCY),          \
+    SONAR_DELAY_PARAMS(SONAR_FIRST_DELAY(u, b) - SONAR_BLANK_SKIP),                 \
+    SONAR_DELAY_PARAMS((u) - SONAR_COUNT_CYCLES), SONAR_FIRST_COUNT(u, b)}
+#define SONAR_UNIT_PARAMS(time) SONAR_PARAMS(SONAR_UNIT_CYCLES(time), SONAR_BLANK_CYCLES)
+
+#define SONAR_BLANK_TICKS   ((unsigned int)(SONAR_TMR1_FREQ / 1000 * SONAR_BLANK_TIME / 10000))
+#define SONAR_OFFSET_TICKS  (SONAR_TICKS_PER_CM / 2)
+
+// SONAR temperature compensation definitions. The speed of sound changes by
+// about 0.18% per degree C, and the SONAR unit times above assume a speed of
+// about 344m/s (21C). Un-comment SONAR_TEMP_COMP to correct sonar_range_cm()
+// and sonar_read() ranges for temperatures between -10C and 40C measured by
+// the on-die temperature indicator (ANTIM). sonar_temp_update() selects one
+// of SONAR_TEMP_BANDS 5C temperature bands from tables calculated at compile
+// time, each holding the sonar_range_cm() kernel parameters (the cm unit,
+// first count and 2cm blanking window at its speed of sound) and the
+// sonar_read() pulse length correction for its temperature. sonar_temp_update()
+// splits the band's correction into up to SONAR_TEMP_TERMS power-of-two terms
+// (within 0.02%), so sonar_read() scales each pulse using only shifts and adds
+// before converting it to cm. The interrupt-driven blanking window stays at
+// SONAR_BLANK_TICKS (2cm at 20C, or 1.9-2.1cm from -10C to 40C), and the half
+// cm rounding offset is scaled along with the pulse. The indicator is set up
+// by sonar_temp_config(), which leaves the PORTC header pins (including H4,
+// shared with the Q1 phototransistor input) unchanged. The temperature
+// indicator is not calibrated: set SONAR_TEMP_OFFSET to the difference between
+// sonarTempReading and SONAR_TEMP_ADC(t10) at a known temperature (t10 in
+// tenths of a degree C).
+// #define SONAR_TEMP_COMP              // Temperature compensated ranging
+#if defined(MINIMAL) && defined(SONAR_TEMP_COMP)
+#error "The MINIMAL build has no ADC code - SONAR_TEMP_COMP can't be used"
+#endif
+#define SONAR_TEMP_OFFSET   0           // Temperature indicator offset (counts)
+#define SONAR_TEMP_ACQ_TIME ADC_TEMP_ACQ_TIME   // Temperature indicator settling time (us)
+#define SONAR_TEMP_BANDS    11          // Temperature bands (-10C to 40C)
+#define SONAR_TEMP_TERMS    4           // Pulse correction terms (shifts)
+
+// Speed of sound in mm/s, instruction cycles per cm of SONAR range, and the
+// pulse length correction (x65536, relative to the 20C speed of sound used by
+// sonar_ticks_to_cm()) at temperature t (C)
+#define SONAR_SOUND_SPEED(t)    (331300L + 606L * (t))
+#define SONAR_TEMP_CYCLES(t)    ((_XTAL_FREQ / 4) * 20L / SONAR_SOUND_SPEED(t))
+#define SONAR_TEMP_SCALE(t)     ((int)(SONAR_SOUND_SPEED(t) * 65536 / SONAR_SOUND_SPEED(20) - 65536))
+
+// Kernel parameters at temperature t (C), and the 10-bit temperature indicator
+// reading at temperature t10 (tenths of a degree C) with a 5V supply:
+// VDD - 4 x (659mV - 1.32mV/C x (t + 40C)).
+#define SONAR_TEMP_PARAMS(t)    SONAR_PARAMS(SONAR_TEMP_CYCLES(t), 2 * SONAR_TEMP_CYCLES(t))
+#define SONAR_TEMP_ADC(t10)     ((unsigned int)((2364000L + 528L * ((t10) + 400)) * 1024 / 5000000) + SONAR_TEMP_OFFSET)
+
+// SONAR ping rate definitions. After each ECHO pulse ends, Timer1 keeps running
+// to time the SONAR module's recovery period, and sonar_ready() reports that
+// the module is ready for the next ping after SONAR_RECOVERY_TIME (1-43ms).
+// Pinging as soon as the module is ready makes the ping rate depend on the
+// target range, so SONAR_MIN_PERIOD can be used to limit the maximum ping rate.
+#define SONAR_RECOVERY_TIME 10          // Minimum time from ECHO end to TRIG (ms)
+#define SONAR_RECOVERY_TICKS ((unsigned int)(SONAR_TMR1_FREQ / 1000 * SONAR_RECOVERY_TIME))
+#define SONAR_MIN_PERIOD    20          // Minimum time between pings (ms)
+
+// SONAR timeout definitions. The range functions give up waiting for the ECHO
+// pulse to start after SONAR_START_TIMEOUT microseconds (HC-SR04 modules
+// normally start the ECHO pulse ~0.5ms after TRIG), and stop counting when the
+// range reaches SONAR_MAX_RANGE units. The worst-case sonar_range_cm() run-time
+// is about SONAR_START_TIMEOUT + (SONAR_MAX_RANGE * 58us), or 16.8ms using the
+// values below. SONAR_WAIT_CYCLES is the length of each pass through the
+// kernel's ECHO start waiting loop (plus 2 cycles every 256 passes), and
+// SONAR_RISE_CYCLES the cycles from the pass that detects the rising edge of
+// ECHO to the start of the blanking delay.
+#define SONAR_START_TIMEOUT 2000        // Maximum ECHO start wait time (us)
+#define SONAR_MAX_RANGE     255         // Maximum range counted (units)
+#define SONAR_WAIT_CYCLES   5           // Cycles per ECHO start waiting pass
+#define SONAR_RISE_CYCLES   6           // Cycles from ECHO check to blanking delay
+#define SONAR_START_LOOPS   (SONAR_START_TIMEOUT * (_XTAL_FREQ / 4000000) / SONAR_WAIT_CYCLES)
+
+// Parallel kernel timing definitions. Each ECHO start waiting pass of the
+// sonar_range_parallel() kernel takes SONAR_PARALLEL_WAIT_CYCLES (plus 2
+// cycles every 256 passes), and each counting pass takes its delay plus
+// SONAR_PARALLEL_CYCLES, checking every ECHO pin in the same cycles whether
+// it is high or low. The first check is made half a cm after the first ECHO
+// pulse starts (less SONAR_PARALLEL_LATENCY, the average cycles taken to
+// detect it), so the first module's range is rounded to the nearest cm.
+#define SONAR_PARALLEL_WAIT_CYCLES 7    // Cycles per ECHO start waiting pass
+#define SONAR_PARALLEL_LATENCY (7 + SONAR_PARALLEL_WAIT_CYCLES / 2) // ECHO start detection cycles
+#define SONAR_PARALLEL_CYCLES (15 + 2 * SONAR_SENSORS)  // Counting pass cycles besides its delay
+#define SONAR_PARALLEL_LOOPS (SONAR_START_TIMEOUT * (_XTAL_FREQ / 4000000) / SONAR_PARALLEL_WAIT_CYCLES)
+#define SONAR_START_TICKS   ((unsigned int)(SONAR_TMR1_FREQ / 1000 * SONAR_START_TIMEOUT / 1000))
+
+// SONAR status definitions (sonarStatus values set by each measurement)
+#define SONAR_OK            0           // Range measurement completed
+#define SONAR_NO_SENSOR     1           // ECHO pulse did not start (no module?)
+#define SONAR_NO_ECHO       2           // No ECHO received within maximum range
+#define SONAR_NOT_READY     3           // ECHO still active, can't re-trigger
+#define SONAR_BLANKED       4           // ECHO ended inside blanking window
+
+// SONAR measurement engine variables (written by the interrupt handlers).
+extern volatile unsigned int sonarPulse;    // ECHO pulse length (Timer1 ticks)
+extern volatile bool sonarDone;             // New sonarPulse result is ready
+extern volatile bool sonarBusy;             // SONAR measurement in progress
+extern volatile unsigned char sonarStatus;  // Last measurement status
+extern volatile bool sonarDraining;         // Waiting for beyond-range ECHO to end
+extern volatile unsigned char sonarKernel[SONAR_KERNEL_SIZE];  // Counting kernel variables
+
+#ifdef SONAR_MULTI_ECHO
+// SONAR multi-echo capture variables (written by the interrupt handlers).
+extern volatile unsigned int sonarEdges[SONAR_EDGES];  // ECHO edge times (ticks)
+extern volatile unsigned char sonarEdgeCount;   // Number of ECHO edges saved
+#endif
+
+#ifdef SONAR_TEMP_COMP
+// SONAR temperature compensation variables (set by sonar_temp_update()).
+extern unsigned int sonarTempReading;   // Temperature indicator reading (10-bit)
+extern unsigned char sonarTempBand;     // Temperature band (0 = -10C, 5C steps)
+#endif
+
+#if defined(SONAR_SCAN) || defined(SONAR_PARALLEL)
+// SONAR scanner variables (written by sonar_scan() or sonar_range_parallel()).
+extern unsigned char sonarRanges[SONAR_SENSORS];    // Range of each module (cm)
+extern unsigned char sonarUpdated;  // Bit set for each updated sonarRanges[]
+#endif
+
+#ifdef SONAR_PARALLEL
+// SONAR parallel ranging variables (written by sonar_range_parallel()). The
+// scheduler tick is lost while interrupts are disabled, so callers add this
+// time back to it (see tick_add() in TASK.h).
+extern unsigned int sonarBlockedTicks;  // Timer1 ticks of the last interrupts-off ping
+#endif
+
+// Prototypes for SONAR.c functions:
+
+/**
+ * Function: void sonar_kernel(void)
+ *
+ * SONAR counting kernel used by the range functions. Waits for the ECHO pulse
+ * to start, rejects pulses ending inside the blanking window, and counts range
+ * units until the pulse ends or the range reaches the maximum, using the
+ * parameters loaded into sonarKernel[] (see SONAR_K_RANGE). Sets
+ * sonarKernel[SONAR_K_STATUS] to the sonarStatus result. Every pass takes an
+ * exact number of cycles, so interrupts must be disabled while it runs.
+ *
+ * Example usage: sonar_kernel();   // Used by BENCH.c to time the kernel
+ */
+void sonar_kernel(void);
+
+/**
+ * Function: unsigned char sonar_range_cm(void)
+ *
+ * Trigger the SONAR module and time the ECHO pulse by counting cycle-exact
+ * 58us (1cm) delay loops. Returns the range to the closest target in cm, or
+ * 0 if no range was measured, and sets sonarStatus. This function blocks, with
+ * interrupts disabled, until the ECHO pulse ends or until the timeouts defined
+ * above expire.
+ *
+ * Example usage: distance = sonar_range_cm();
+ */
+unsigned char sonar_range_cm(void);
+
+/**
+ * Function: unsigned char sonar_range_hcm(void)
+ *
+ * Return the range to the closest target in 0.5cm units (see sonar_range_cm).
+ *
+ * Example usage: distance = sonar_range_hcm();
+ */
+unsigned char sonar_range_hcm(void);
+
+/**
+ * Function: unsigned char sonar_range_mm2(void)
+ *
+ * Return the range to the closest target in 2mm units (see sonar_range_cm).
+ *
+ * Example usage: distance = sonar_range_mm2();
+ */
+unsigned char sonar_range_mm2(void);
+
+/**
+ * Function: unsigned char sonar_range_in(void)
+ *
+ * Return the range to the closest target in inches (see sonar_range_cm).
+ *
+ * Example usage: distance = sonar_range_in();
+ */
+unsigned char sonar_range_in(void);
+
+/**
+ * Function: void sonar_config(void)
+ *
+ * Configure the TRIG output pin, Timer1 and the ECHO (INT) interrupt used by
+ * the interrupt-driven SONAR measurement functions, and enable interrupts.
+ */
+void sonar_config(void);
+
+/**
+ * Function: bool sonar_start(void)
+ *
+ * Trigger a new interrupt-driven SONAR measurement and return immediately.
+ * Returns false (and does not trigger) if a measurement is still in progress
+ * or the ECHO pulse from a previous measurement has not yet ended.
+ *
+ * Example usage: sonar_start();
+ */
+bool sonar_start(void);
+
+/**
+ * Function: bool sonar_arm(void)
+ *
+ * Arm Timer1 and the ECHO interrupt to capture the next ECHO pulse, without
+ * triggering the SONAR module. Use when the SONAR module is triggered by other
+ * code (used by sonar_start() and the benchmark program). Returns false if a
+ * measurement is still in progress or the last ECHO pulse has not ended.
+ *
+ * Example usage: if(sonar_arm()) distance = sonar_range_cm();
+ */
+bool sonar_arm(void);
+
+/**
+ * Function: bool sonar_ready(void)
+ *
+ * Return true if the SONAR module is ready to be pinged: no measurement is in
+ * progress, the last ECHO pulse has ended, and the SONAR_RECOVERY_TIME since
+ * the end of the last ECHO pulse has passed.
+ *
+ * Example usage: if(sonar_ready()) sonar_start();
+ */
+bool sonar_ready(void);
+
+/**
+ * Function: void sonar_cancel(void)
+ *
+ * Abandon the interrupt-driven measurement in progress, e.g. when the ECHO
+ * pulse of a faulty module never ends. A measurement without a result
+ * finishes with a range of 0 and sonarStatus set to SONAR_NO_ECHO. The module
+ * can't be pinged again until its ECHO pulse ends (see sonar_ready()).
+ *
+ * Example usage: if(drainTime == 0) sonar_cancel();
+ */
+void sonar_cancel(void);
+
+/**
+ * Function: void sonar_max_range(unsigned char maxRange)
+ *
+ * Set the maximum range (in cm) of interrupt-driven measurements. Measurements
+ * finish as soon as the ECHO pulse length reaches maxRange, returning a range
+ * of 0 and setting sonarStatus to SONAR_NO_ECHO, and the rest of the ECHO
+ * pulse is ignored. The default maximum range is SONAR_MAX_RANGE. Ranges
+ * inside the blanking window are raised to the first range beyond it (3cm).
+ * Can be called during a measurement (applies from the next ECHO pulse).
+ *
+ * Example usage: sonar_max_range(90);
+ */
+void sonar_max_range(unsigned char);
+
+/**
+ * Function: unsigned char sonar_read(void)
+ *
+ * Return the range in cm (0 if no ECHO was received) from the most recent
+ * completed measurement, and clear the sonarDone flag. Check sonarStatus to
+ * find out why a range of 0 was returned.
+ *
+ * Example usage: if(sonarDone) distance = sonar_read();
+ */
+unsigned char sonar_read(void);
+
+/**
+ * Function: unsigned char sonar_echo_count(void)
+ *
+ * Return the number of ECHO returns recorded by the most recent completed
+ * multi-echo measurement (SONAR_MULTI_ECHO).
+ *
+ * Example usage: if(sonar_echo_count() > 1) wall = sonar_echo_range(sonar_echo_count() - 1);
+ */
+unsigned char sonar_echo_count(void);
+
+/**
+ * Function: unsigned char sonar_echo_range(unsigned char n)
+ *
+ * Return the range in cm of ECHO return n (0 is the first return) recorded by
+ * the most recent completed multi-echo measurement, or 0 if there are fewer
+ * than n + 1 returns.
+ *
+ * Example usage: target = sonar_echo_range(0);
+ */
+unsigned char sonar_echo_range(unsigned char);
+
+/**
+ * Function: unsigned char sonar_us_to_cm(unsigned int us)
+ *
+ * Convert an ECHO pulse length in microseconds (measured by a microsecond
+ * timer) to a range in cm, using a reciprocal shift-and-add multiplication
+ * instead of dividing by 58. Returns 255 for pulses of 255cm or longer.
+ *
+ * Example usage: distance = sonar_us_to_cm(timerResult);
+ */
+unsigned char sonar_us_to_cm(unsigned int);
+
+/**
+ * Function: unsigned char sonar_ticks_to_cm(unsigned int ticks)
+ *
+ * Convert an ECHO pulse length in Timer1 ticks (sonarPulse) to a range in cm,
+ * using a reciprocal shift-and-add multiplication instead of dividing by 87.
+ * Returns 255 for pulses of 255cm or longer. Used by sonar_read().
+ *
+ * Example usage: distance = sonar_ticks_to_cm(sonarPulse);
+ */
+unsigned char sonar_ticks_to_cm(unsigned int);
+
+/**
+ * Function: void sonar_temp_config(void)
+ *
+ * Configure the ADC and the fixed voltage reference module's temperature
+ * indicator for sonar_temp_update(). Only the ADC and FVR registers are
+ * changed, so the PORTC header pins set by sonar_config() are not affected.
+ *
+ * Example usage: sonar_temp_config();
+ */
+void sonar_temp_config(void);
+
+/**
+ * Function: void sonar_temp_update(void)
+ *
+ * Read the on-die temperature indicator, and select the temperature band used
+ * to compensate SONAR ranges for the speed of sound. Takes SONAR_TEMP_ACQ_TIME
+ * plus one conversion. Call sonar_temp_config() first, and then call this function
+ * every few seconds, or more often if the temperature changes quickly. Returns
+ * without reading the temperature while an ADC_burst_start() burst is running.
+ *
+ * Example usage: sonar_temp_update();
+ */
+void sonar_temp_update(void);
+
+/**
+ * Function: void sonar_scan(void)
+ *
+ * Multi-sensor SONAR scanner. Call once every millisecond. Saves each completed
+ * measurement in sonarRanges[] (and sets the module's bit in sonarUpdated),
+ * then pings the next SONAR module after the SONAR_GUARD_TIME delay.
+ *
+ * Example usage: sonar_scan();
+ */
+void sonar_scan(void);
+
+/**
+ * Function: void sonar_range_parallel(void)
+ *
+ * Ping all SONAR modules at once and count the ECHO pulses of every module in
+ * cm in the same cycle-counted assembly language kernel pass, by reading all
+ * of the ECHO pins in PORTC each pass. Saves the range of each module in
+ * sonarRanges[] (0 if no range), and sets all sonarUpdated bits. This function
+ * blocks, with interrupts disabled, until all ECHO pulses end, or until the
+ * timeouts defined above expire, and saves the Timer1 ticks it blocked for in
+ * sonarBlockedTicks.
+ *
+ * Example usage: sonar_range_parallel();
+ */
+void sonar_range_parallel(void);
+
+/**
+ * Function: void sonar_echo_isr(void)
+ *
+ * SONAR ECHO interrupt handler. Captures the ECHO pulse length on the INT pin
+ * edges. Called by the UBMP420.c interrupt dispatcher (ISR_INT).
+ */
+void sonar_echo_isr(void);
+
+/**
+ * Function: void sonar_timer_isr(void)
+ *
+ * SONAR timeout interrupt handler. Ends measurements with no ECHO, or beyond
+ * the maximum range, on Timer1 overflow. Called by the UBMP420.c interrupt
+ * dispatcher (ISR_TMR1).
+ */
+void sonar_timer_isr(void);
@@ -0,0 +1,79 @@
+/*==============================================================================
+ File: STATS.c
+ Date: October 14, 2026
+
+ SONAR pipeline instrumentation functions
+
+ Functions used by the instrumentation build (see STATS.h) to measure the main
+ loop time, and to send the instrumentation counters over the serial telemetry
+ link. Include the STATS.h file in your main program to call these functions.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "TASK.h"            // Include task scheduler definitions
+#include    "SERIAL.h"          // Include serial telemetry definitions
+#include    "STATS.h"           // Include instrumentation definitions
+
+#ifdef STATS
+
+struct stats stats;             // Instrumentation counters
+unsigned char statsStartTicks;  // Main loop start tick count
+unsigned char statsStartCounts; // Main loop start Timer0 count
+
+// Clear all instrumentation counters.
+void stats_clear(void)
+{
+    unsigned char *counter = (unsigned char *)&stats;
+    for(unsigned char i = 0; i != sizeof(stats); i++)
+    {
+        counter[i] = 0;
+    }
+}
+
+// Read the tick count and Timer0 together. The tick count is read again in
+// case a tick interrupt occurred in between.
+static void stats_time(unsigned char *ticks, unsigned char *counts)
+{
+    do {
+        *ticks = tickCount;
+        *counts = TMR0;
+    } while(*ticks != tickCount);
+}
+
+// Save the main loop start time.
+void stats_loop_start(void)
+{
+    stats_time(&statsStartTicks, &statsStartCounts);
+}
+
+// Update the longest main loop time. Timer0 counts from TICK_RELOAD to 255
+// during each tick, so the loop time is the number of whole ticks times
+// TICK_COUNTS, plus the change in the Timer0 count.
+void stats_loop_end(void)
+{
+    unsigned char ticks;
+    unsigned char counts;
+    stats_time(&ticks, &counts);
+    unsigned int loopTime = (unsigned char)(ticks - statsStartTicks) * TICK_COUNTS
+        + counts - statsStartCounts;
+    if(loopTime > stats.maxLoop)
+    {
+        stats.maxLoop = loopTime;
+    }
+}
+
+#ifdef TELEMETRY
+// Send the instrumentation counters over the serial telemetry link. The
+// counters are only written by the main program, so the multi-byte counters
+// can be copied without disabling interrupts.
+void stats_send(void)
+{
+    serial_packet(STATS_SYNC, (unsigned char *)&stats, sizeof(stats));
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/*==============================================================================
+ File: STATS.h
+ Date: October 14, 2026
+
+ SONAR pipeline instrumentation symbolic constant and function definitions.
+
+ Instrumentation definitions section:
+ Option used to build the instrumentation counters into the program, and the
+ counter macros used by the SONAR functions.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the STATS.c file.
+==============================================================================*/
+
+// Instrumentation definitions. Un-comment STATS (or build the 'Instrumented'
+// project configuration) to count the SONAR measurement results and timing
+// in the stats structure. Without STATS, the counter macros compile to
+// nothing, and the SONAR functions are unchanged. Counters are only updated
+// outside of the range counting loops, once for each measurement, and only by
+// the main program - interrupt-driven measurements are counted by sonar_read()
+// when their results are read - so that no counter is ever written by an
+// interrupt handler part-way through being copied by stats_send().
+// #define STATS                    // Build instrumentation counters
+#define STATS_SYNC      0x5A        // Stats telemetry packet start byte
+
+#ifdef STATS
+#define STATS_INC(counter)      stats.counter ++
+#define STATS_ADD(counter, n)   stats.counter += (n)
+#define STATS_LOOP_START()      stats_loop_start()
+#define STATS_LOOP_END()        stats_loop_end()
+
+// Instrumentation counters. Every ping ends as one of echoes, noSensor, noEcho
+// or blanked, so those four counters add up to pings. Wait cycles are the
+// instruction cycles spent waiting for ECHO pulses to start, and count cycles
+// are the instruction cycles spent timing (or counting) ECHO pulses.
+struct stats {
+    unsigned int pings;         // SONAR pings sent
+    unsigned int echoes;        // ECHO pulses measured within range
+    unsigned int noSensor;      // ECHO pulses that didn't start (timeouts)
+    unsigned int noEcho;        // Measurements beyond maximum range
+    unsigned int blanked;       // ECHO pulses ended inside the blanking window
+    unsigned int notReady;      // Pings refused while ECHO was still active
+    unsigned long waitCycles;   // Cycles waiting for ECHO pulses to start
+    unsigned long countCycles;  // Cycles timing ECHO pulses
+    unsigned int maxLoop;       // Longest main loop time (5.33us Timer0 counts)
+};
+
+extern struct stats stats;      // Instrumentation counters
+#else
+#define STATS_INC(counter)
+#define STATS_ADD(counter, n)
+#define STATS_LOOP_START()
+#define STATS_LOOP_END()
+#endif
+
+// Prototypes for STATS.c functions:
+
+/**
+ * Function: void stats_clear(void)
+ *
+ * Clear all of the instrumentation counters.
+ */
+void stats_clear(void);
+
+/**
+ * Function: void stats_loop_start(void)
+ *
+ * Save the main loop start time. Used by STATS_LOOP_START(), which is placed
+ * at the start of the main loop. Requires the TASK.c 1ms tick.
+ */
+void stats_loop_start(void);
+
+/**
+ * Function: void stats_loop_end(void)
+ *
+ * Update the longest main loop time. Used by STATS_LOOP_END(), which is placed
+ * at the end of the main loop.
+ */
+void stats_loop_end(void);
+
+/**
+ * Function: void stats_send(void)
+ *
+ * Send the stats structure over the serial telemetry link as a STATS_SYNC
+ * packet (see serial_packet()), and return immediately.
+ *
+ * Example usage: task_add(stats_send, 250);
+ */
+void stats_send(void);
@@ -0,0 +1,92 @@
+/*==============================================================================
+ File: TASK.c
+ Date: October 14, 2026
+
+ Cooperative task scheduler functions
+
+ A Timer0 interrupt counts 1ms ticks, and the task_run() function, called from
+ the main loop, runs each task function added by task_add() at its own period.
+ Tasks are short functions that do one step of their work and return, instead
+ of waiting in time delays, so that every task runs on time. Include the TASK.h
+ file in your main program to call these functions.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "TASK.h"            // Include task scheduler definitions
+
+// Tick and task scheduler variables
+volatile unsigned char tickCount = 0;   // 1ms tick counter (written by tick_isr())
+unsigned char taskTick = 0;     // Last tick processed by task_run()
+unsigned int taskTime = 0;      // Scheduler time (ms, wraps every 65.5s)
+unsigned char taskCount = 0;    // Number of tasks in the task table
+
+// Task table
+void (*taskFunction[TASKS_MAX])(void);  // Task functions
+unsigned char taskPeriod[TASKS_MAX];    // Task run periods (ticks)
+unsigned char taskTimer[TASKS_MAX];     // Ticks until each task is run again
+
+// Configure Timer0 for a 1ms tick interrupt.
+void tick_config(void)
+{
+    OPTION_REG = (OPTION_REG & 0b11110000) | TICK_PRESCALER;  // Prescaler 1:64
+    TMR0 = TICK_RELOAD;
+    TMR0IF = 0;
+    TMR0IE = 1;                 // Enable Timer0 interrupt
+}
+
+// Tick interrupt handler - adding the reload value to TMR0 keeps the whole
+// counts that have passed since the overflow, and the reload alternates
+// between 187 and 188 counts to average 187.5 counts (1ms). The part-count in
+// the prescaler is lost when TMR0 is written (see TASK.h).
+void tick_isr(void)
+{
+    TMR0 = TMR0 + (unsigned char)(TICK_RELOAD - (tickCount & 1));
+    tickCount ++;
+}
+
+// Add ticks that were missed while interrupts were disabled.
+void tick_add(unsigned char ticks)
+{
+    bool interrupts = GIE;
+    GIE = 0;
+    tickCount += ticks;
+    GIE = interrupts;
+}
+
+// Add a task to run every period ticks - returns false if the table is full.
+bool task_add(void (*task)(void), unsigned char period)
+{
+    if(taskCount == TASKS_MAX)
+    {
+        return(false);
+    }
+    taskFunction[taskCount] = task;
+    taskPeriod[taskCount] = period;
+    taskTimer[taskCount] = period;
+    taskCount ++;
+    return(true);
+}
+
+// Run each task that is due once for every tick since the last call. Reading
+// the single-byte tickCount is atomic, so interrupts don't need to be disabled.
+void task_run(void)
+{
+    while(taskTick != tickCount)
+    {
+        taskTick ++;
+        taskTime ++;
+        for(unsigned char i = 0; i != taskCount; i++)
+        {
+            taskTimer[i] --;
+            if(taskTimer[i] == 0)
+            {
+                taskTimer[i] = taskPeriod[i];
+                taskFunction[i]();
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*==============================================================================
+ File: TASK.h
+ Date: October 14, 2026
+
+ Cooperative task scheduler symbolic constant and function definitions.
+
+ Tick definitions section:
+ Timer0 settings used to generate the 1ms scheduler tick.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the TASK.c file.
+==============================================================================*/
+
+// Tick definitions. Timer0 counts FOSC/4 (12MHz) instruction cycles through a
+// 1:64 prescaler (5.33us counts), so a 1ms tick is 187.5 Timer0 counts.
+// tick_isr() reloads Timer0 to overflow after TICK_COUNTS and TICK_COUNTS + 1
+// counts on alternate ticks, averaging exactly 1ms. Writing TMR0 clears the
+// prescaler, so each tick also loses the part of a count that has passed when
+// tick_isr() writes TMR0 (the interrupt latency, less than 64 cycles unless a
+// higher-priority handler runs first) plus the 2 cycles that TMR0 is stopped
+// after being written. Ticks are up to 0.5% (typically about 0.2%) longer than
+// 1ms, so use a crystal-timed source such as Timer1 for long time intervals.
+#define TICK_PRESCALER  0b00000101  // OPTION_REG Timer0 prescaler bits (1:64)
+#define TICK_COUNTS     ((_XTAL_FREQ / 4 / 64) / 1000)  // Timer0 counts per tick (187)
+#define TICK_RELOAD     (256 - TICK_COUNTS)             // Timer0 reload value
+
+// Task scheduler definitions
+#define TASKS_MAX       6           // Maximum number of scheduled tasks
+
+extern volatile unsigned char tickCount;    // 1ms tick counter (wraps at 256)
+extern unsigned int taskTime;   // Scheduler time (ms, updated by task_run())
+
+// Prototypes for TASK.c functions:
+
+/**
+ * Function: void tick_config(void)
+ *
+ * Configure Timer0 to generate a 1ms tick interrupt, and enable the Timer0
+ * interrupt. tick_isr() must be set as the ISR_TMR0 handler in UBMP420.h.
+ */
+void tick_config(void);
+
+/**
+ * Function: void tick_isr(void)
+ *
+ * Timer0 tick interrupt handler. Reloads Timer0 and counts 1ms ticks. Called
+ * by the UBMP420.c interrupt dispatcher (ISR_TMR0).
+ */
+void tick_isr(void);
+
+/**
+ * Function: void tick_add(unsigned char ticks)
+ *
+ * Add ticks that tick_isr() missed while interrupts were disabled. Timer0 keeps
+ * counting with interrupts disabled, but latches only one tick interrupt, so a
+ * function that disables interrupts for longer than a tick must time how long
+ * it did so (e.g. using Timer1) and add the other ticks back. task_run() then
+ * runs the tasks that became due in the meantime.
+ *
+ * Example usage: tick_add(lostTicks);
+ */
+void tick_add(unsigned char);
+
+/**
+ * Function: bool task_add(void (*task)(void), unsigned char period)
+ *
+ * Add a task function to the scheduler, to be run every period ticks (1-255
+ * ms). Tasks run in the order that they were added. Returns false if the task
+ * table is full.
+ *
+ * Example usage: task_add(button_task, 1);
+ */
+bool task_add(void (*)(void), unsigned char);
+
+/**
+ * Function: void task_run(void)
+ *
+ * Run all tasks that are due. Call continuously from the main loop. Each task
+ * is run once for every period that has passed, so a slow task delays, but
+ * doesn't skip, the tasks after it. Tasks must return quickly (well under 1ms)
+ * to keep the timing jitter of every task below one tick, and a task that has
+ * to disable interrupts for longer than a tick must add the ticks it blocked
+ * back using tick_add().
+ *
+ * Example usage: task_run();
+ */
+void task_run(void);
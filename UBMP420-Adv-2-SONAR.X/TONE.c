@@ -0,0 +1,99 @@
+/*==============================================================================
+ File: TONE.c
+ Date: October 14, 2026
+
+ Beeper tone generator functions
+
+ A Timer2 interrupt generates a tone on the piezo beeper in beeps that repeat
+ at a rate set by tone_period(), so the main program only has to update the
+ beep period (e.g. from the range after each ping) instead of timing the tone
+ itself. The BEEPER pin (RA4) isn't connected to a PWM output, so the tone is
+ toggled by the interrupt handler, using about 2% of the processor's time
+ while the tone generator is running. Timer2 is stopped while the beeper is
+ silent (TONE_OFF), so the interrupt uses no time at all when not beeping.
+ Include the TONE.h file in your main program to call these functions, and
+ enable PROXIMITY_TONE in CONFIG.h to compile them.
+==============================================================================*/
+
+#include    "xc.h"              // XC compiler general include file
+#include    "stdint.h"          // Include integer definitions
+#include    "stdbool.h"         // Include Boolean (true/false) definitions
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "TONE.h"            // Include tone generator definitions
+
+#ifdef PROXIMITY_TONE
+
+// Tone generator variables (shared with tone_isr())
+volatile unsigned int tonePeriodNext = TONE_OFF;    // Period set by tone_period()
+unsigned int tonePeriod = TONE_OFF; // Current beep period (ms)
+unsigned int toneTime = 0;      // Time since the start of the beep period (ms)
+unsigned char toneTicks = TONE_TICKS;   // Tone interrupts until next ms
+bool toneOn = false;            // Beep is sounding
+
+// Configure Timer2 for the tone interrupt.
+void tone_config(void)
+{
+    BEEPER = 0;
+    TMR2 = 0;
+    PR2 = TONE_PR2;
+    T2CON = TONE_T2CON;         // Timer2 stays off until tone_period()
+    TMR2IF = 0;
+    TMR2IE = 1;                 // Enable Timer2 interrupt
+}
+
+// Set the beep period. The Timer2 interrupt is disabled while both bytes are
+// written so that tone_isr() can't read a half-written period. If Timer2 was
+// stopped by a silent period, restart it with the current period already
+// over, so the new period starts at the next beep timer ms.
+void tone_period(unsigned int period)
+{
+    TMR2IE = 0;
+    tonePeriodNext = period;
+    if(!TMR2ON && period != TONE_OFF)
+    {
+        tonePeriod = TONE_OFF;
+        toneTime = 0;
+        toneTicks = TONE_TICKS;
+        TMR2 = 0;
+        TMR2ON = 1;
+    }
+    TMR2IE = 1;
+}
+
+// Tone interrupt handler - toggle the beeper while the beep is on, and every
+// ms end the beep after TONE_BEEP_TIME, or start the next beep period. Stops
+// Timer2 when the next beep period is silent.
+void tone_isr(void)
+{
+    if(toneOn)
+    {
+        BEEPER = !BEEPER;
+    }
+    toneTicks --;
+    if(toneTicks != 0)
+    {
+        return;
+    }
+    toneTicks = TONE_TICKS;
+    
+    toneTime ++;
+    if(toneTime == TONE_BEEP_TIME && tonePeriod > TONE_BEEP_TIME)
+    {
+        toneOn = false;         // End the beep, leaving the beeper off
+        BEEPER = 0;
+    }
+    if(toneTime >= tonePeriod)
+    {
+        tonePeriod = tonePeriodNext;    // Start the next beep period
+        toneTime = 0;
+        toneOn = (tonePeriod != TONE_OFF);
+        if(!toneOn)
+        {
+            BEEPER = 0;
+            TMR2ON = 0;         // Silent - stop Timer2 until tone_period()
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*==============================================================================
+ File: TONE.h
+ Date: October 14, 2026
+
+ Beeper tone generator symbolic constant and function definitions.
+
+ Tone definitions section:
+ Timer2 settings used to generate the beeper tone, and the beep timing.
+
+ Function prototypes section:
+ Function prototype definitions for each of the functions in the TONE.c file.
+==============================================================================*/
+
+// Tone definitions. Timer2 counts FOSC/4 (12MHz) instruction cycles through a
+// 1:16 prescaler, and interrupts every TONE_PR2 + 1 counts (~4kHz) to toggle
+// BEEPER, producing a ~2kHz tone. Every TONE_TICKS interrupts (~1ms) the beep
+// timer is updated to switch the tone on for TONE_BEEP_TIME at the start of
+// each beep period set by tone_period(). Timer2 only runs while a beep period
+// is set, and is stopped when the beeper is silenced with TONE_OFF.
+#define TONE_T2CON      0b00000010  // Timer2 off, 1:16 prescaler, 1:1 postscaler
+#define TONE_PR2        186         // Timer2 period (187 x 1.33us = 249us)
+#define TONE_TICKS      4           // Tone interrupts per beep timer ms
+#define TONE_BEEP_TIME  50          // Beep length (ms)
+#define TONE_OFF        0           // tone_period() setting for silence
+
+// Prototypes for TONE.c functions:
+
+/**
+ * Function: void tone_config(void)
+ *
+ * Configure Timer2 to generate the tone interrupt, and enable the Timer2
+ * interrupt, starting with the tone off (and Timer2 stopped). tone_isr() must
+ * be set as the ISR_TMR2 handler in UBMP420.h.
+ */
+void tone_config(void);
+
+/**
+ * Function: void tone_period(unsigned int period)
+ *
+ * Set the beep repetition period in ms. Periods up to TONE_BEEP_TIME produce a
+ * continuous tone, and TONE_OFF silences the beeper. The new period starts at
+ * the end of the current beep period, so it can be set after every ping.
+ * Timer2 is restarted if it was stopped, starting the new period within 1ms.
+ *
+ * Example usage: tone_period(200);
+ */
+void tone_period(unsigned int);
+
+/**
+ * Function: void tone_isr(void)
+ *
+ * Timer2 tone interrupt handler. Toggles BEEPER while a beep is on, and times
+ * the beeps. Called by the UBMP420.c interrupt dispatcher (ISR_TMR2).
+ */
+void tone_isr(void);
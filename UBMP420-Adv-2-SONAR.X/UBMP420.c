@@ -6,8 +6,11 @@
  
  Initialization functions used to configure the PIC16F1459 oscillator, on-board
  UBMP4 I/O devices, and ADC (analog-to-digital converter), as well as ADC
- channel selection and conversion functions. Include the UBMP420.h file in your
- main program to call these functions. Add or modify functions as needed.
+ channel selection, conversion and burst functions, low-power sleep and Timer1
+ pulse measurement functions, and the interrupt service routine, which
+ dispatches each interrupt to the handler functions selected in UBMP420.h.
+ Include the UBMP420.h file in your main program to call these functions. Add
+ or modify functions as needed.
 ==============================================================================*/
 
 #include    "xc.h"              // XC compiler general include file
@@ -16,6 +19,15 @@
 
 #include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
 
+#ifdef ADC_BURST
+// ADC burst variables (shared with ADC_burst_isr())
+const unsigned char *adcBurstChannels;  // Channel list being converted
+unsigned char *adcBurstResults; // Results array being filled
+unsigned char adcBurstCount;    // Channels left to convert
+unsigned char adcBurstFvr;      // FVRCON setting to restore after the burst
+volatile bool adcBurstDone = false; // ADC_burst_start() burst complete
+#endif
+
 // Configure oscillator for 48 MHz operation (required for USB bootloader).
 void OSC_config(void)
 {
@@ -43,7 +55,111 @@ void UBMP4_config(void)
     ANSELC = 0b00000000;        // Disable analog input on all PORTC input pins
     TRISC = 0b00001111;         // Set LED pins as outputs, H1-H4 pins as inputs
 
-    // TODO - Enable interrupts here, if required.
+    // Clear interrupt enables and flags. Peripheral configuration functions
+    // (e.g. sonar_config()) enable their own interrupt sources.
+    INTCON = 0b00000000;        // Disable all core interrupts, clear flags
+    PIE1 = 0b00000000;          // Disable all peripheral interrupts
+    PIE2 = 0b00000000;
+    PIR1 = 0b00000000;          // Clear peripheral interrupt flags
+    PIR2 = 0b00000000;
+    PEIE = 1;                   // Enable peripheral interrupts
+    GIE = 1;                    // Enable global interrupts
+}
+
+// Declare the interrupt handlers selected in UBMP420.h
+#ifdef ISR_INT
+void ISR_INT(void);
+#endif
+#ifdef ISR_TMR1
+void ISR_TMR1(void);
+#endif
+#ifdef ISR_TMR0
+void ISR_TMR0(void);
+#endif
+#ifdef ISR_TMR2
+void ISR_TMR2(void);
+#endif
+#ifdef ISR_IOC
+void ISR_IOC(void);
+#endif
+#ifdef ISR_RX
+void ISR_RX(void);
+#endif
+#ifdef ISR_TX
+void ISR_TX(void);
+#endif
+#ifdef ISR_SSP
+void ISR_SSP(void);
+#endif
+#ifdef ISR_ADC
+void ISR_ADC(void);
+#endif
+
+// Interrupt service routine - dispatch each pending interrupt to its handler
+// in priority order (highest first). Checking each source's enable bit as well
+// as its flag skips sources whose flags are set while they are not in use.
+void __interrupt() isr(void)
+{
+#ifdef ISR_INT
+    if(INTE && INTF)            // INT pin edge
+    {
+        INTF = 0;
+        ISR_INT();
+    }
+#endif
+#ifdef ISR_TMR1
+    if(TMR1IE && TMR1IF)        // Timer1 overflow
+    {
+        TMR1IF = 0;
+        ISR_TMR1();
+    }
+#endif
+#ifdef ISR_TMR0
+    if(TMR0IE && TMR0IF)        // Timer0 overflow
+    {
+        TMR0IF = 0;
+        ISR_TMR0();
+    }
+#endif
+#ifdef ISR_TMR2
+    if(TMR2IE && TMR2IF)        // Timer2 period match
+    {
+        TMR2IF = 0;
+        ISR_TMR2();
+    }
+#endif
+#ifdef ISR_IOC
+    if(IOCIE && IOCIF)          // PORTB interrupt-on-change (clear IOCBF bits)
+    {
+        ISR_IOC();
+    }
+#endif
+#ifdef ISR_RX
+    if(RCIE && RCIF)            // EUSART received byte (read RCREG)
+    {
+        ISR_RX();
+    }
+#endif
+#ifdef ISR_TX
+    if(TXIE && TXIF)            // EUSART transmit buffer empty (write TXREG)
+    {
+        ISR_TX();
+    }
+#endif
+#ifdef ISR_SSP
+    if(SSP1IE && SSP1IF)        // MSSP I2C byte (SCL held until handled)
+    {
+        SSP1IF = 0;
+        ISR_SSP();
+    }
+#endif
+#ifdef ISR_ADC
+    if(ADIE && ADIF)            // ADC conversion complete
+    {
+        ADIF = 0;
+        ISR_ADC();
+    }
+#endif
 }
 
 // Configure ADC for 8-bit conversion from on-board phototransistor Q1 (AN7).
@@ -92,4 +208,147 @@ unsigned char ADC_read_channel(unsigned char channel)
         ;                       // Terminating loop on new line silences warning
     ADON = 0;                   // Turn the ADC off
     return (ADRESH);            // Return the MSB (upper 8-bits) of the result
-}
\ No newline at end of file
+}
+
+// Switch the ADC to the next burst channel, enabling the temperature indicator
+// if it is selected, and wait for the channel's acquisition time.
+static void ADC_burst_switch(unsigned char channel)
+{
+    ADCON0 = (ADCON0 & 0b10000011) | channel;   // Switch channel
+    if(channel == ANTIM)        // Allow input to settle (charges internal cap.)
+    {
+        FVRCON = FVRCON | 0b00110000;   // Enable temperature indicator, high range
+        __delay_us(ADC_TEMP_ACQ_TIME);
+    }
+    else
+    {
+        __delay_us(ADC_ACQ_TIME);
+    }
+}
+
+// Convert a list of ADC channels in one burst, leaving the ADC on between
+// conversions (use channel constants defined in UBMP420.h - e.g. ANQ1).
+void ADC_burst(const unsigned char *channels, unsigned char *results, unsigned char count)
+{
+    ADIE = 0;                   // Poll conversions (no interrupt)
+    unsigned char fvr = FVRCON; // Save temperature indicator setting
+    ADON = 1;                   // Turn the ADC on for the whole burst
+    while(count != 0)
+    {
+        ADC_burst_switch(*channels);
+        GO = 1;                 // Start the conversion by setting Go/~Done bit
+        while(GO)               // Wait for the conversion to finish (GO==0)
+            ;                   // Terminating loop on new line silences warning
+        *results = ADRESH;      // Save the MSB (upper 8-bits) of the result
+        channels ++;
+        results ++;
+        count --;
+    }
+    ADON = 0;                   // Turn the ADC off
+    FVRCON = fvr;               // Restore temperature indicator setting
+}
+
+#ifdef ADC_BURST
+// Start an interrupt-driven ADC burst, and return without waiting.
+void ADC_burst_start(const unsigned char *channels, unsigned char *results, unsigned char count)
+{
+    if(count == 0)
+    {
+        adcBurstDone = true;    // Nothing to convert
+        return;
+    }
+    adcBurstChannels = channels;
+    adcBurstResults = results;
+    adcBurstCount = count;
+    adcBurstDone = false;
+    adcBurstFvr = FVRCON;       // Save temperature indicator setting
+    ADON = 1;                   // Turn the ADC on for the whole burst
+    ADC_burst_switch(*channels);    // Switch to first channel and let it settle
+    ADIF = 0;
+    ADIE = 1;                   // Interrupt at the end of each conversion
+    GO = 1;
+}
+
+// ADC burst interrupt handler - save the result, then switch to the next
+// channel and start its conversion once it settles, or turn off the ADC after
+// the last channel.
+void ADC_burst_isr(void)
+{
+    *adcBurstResults = ADRESH;
+    adcBurstResults ++;
+    adcBurstChannels ++;
+    adcBurstCount --;
+    if(adcBurstCount == 0)
+    {
+        ADIE = 0;
+        ADON = 0;
+        FVRCON = adcBurstFvr;   // Restore temperature indicator setting
+        adcBurstDone = true;
+        return;
+    }
+    ADC_burst_switch(*adcBurstChannels);
+    GO = 1;
+}
+#endif
+
+// Sleep until the WDT period (use WDT period constants defined in UBMP420.h
+// header file - e.g. WDT_64MS) expires or an interrupt wakes the processor.
+// The WDT wakes the processor from sleep instead of resetting it.
+void sleep_wdt(unsigned char period)
+{
+    unsigned char wdtPeriod = WDTCON;   // Save watchdog reset period
+    WDTCON = period;            // Set wake-up period and clear WDT
+    CLRWDT();
+    SLEEP();                    // Stop oscillator until WDT or interrupt wake
+    NOP();                      // Instruction after SLEEP runs on wake-up
+    WDTCON = wdtPeriod;         // Restore watchdog reset period
+    CLRWDT();
+    while(!PLLRDY);             // Wait for PLL re-lock (disable for simulation)
+}
+
+// Configure Timer1 to count at the specified rate (use Timer1 rate constants
+// defined in UBMP420.h header file - e.g. TIMER_1_5MHZ), and clear it.
+void timer_config(unsigned char rate)
+{
+    T1CON = rate;               // Set Timer1 clock source and prescaler
+    T1GCON = 0b00000000;        // Disable Timer1 gate (count continuously)
+    TMR1IE = 0;                 // Poll Timer1 overflow flag (no interrupt)
+    timer_clear();
+}
+
+// Stop Timer1, and clear its count and overflow flag.
+void timer_clear(void)
+{
+    TMR1ON = 0;
+    TMR1H = 0;
+    TMR1L = 0;
+    TMR1IF = 0;
+}
+
+// Measure the length of the next high pulse on TIMER_IN in Timer1 ticks. Timer1
+// times out the wait for the pulse to start, then restarts to time the pulse.
+// Returns 0 if the pulse doesn't start, or is too long, before Timer1 overflows.
+unsigned int timer_pulse(void)
+{
+    TMR1ON = 1;                 // Time out waiting for pulse from timer_clear()
+    while(TIMER_IN == 0)
+    {
+        if(TMR1IF)              // No pulse before Timer1 overflow
+        {
+            timer_clear();
+            return (0);
+        }
+    }
+    timer_clear();              // Restart Timer1 at the start of the pulse
+    TMR1ON = 1;
+    while(TIMER_IN == 1)
+    {
+        if(TMR1IF)              // Pulse too long to measure
+        {
+            timer_clear();
+            return (0);
+        }
+    }
+    TMR1ON = 0;                 // Stop Timer1 at the end of the pulse
+    return (TMR1);
+}
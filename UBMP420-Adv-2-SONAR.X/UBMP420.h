@@ -14,6 +14,10 @@
  both an input definition as well as an output definition (e.g. H1IN and H1OUT).
  Add or modify symbolic definitions as needed.
  
+ Pin descriptor definitions section:
+ Port and bit number pairs describing the UBMP4 header pins, and the macros that
+ convert a pin descriptor into the pin's register bits and bit masks.
+ 
  ADC input channel definitions section:
  Definitions representing the ADCON0 register channel select (CHS) bits, which
  are used to switch between ADC channels available on UBMP4. These definitions
@@ -25,6 +29,8 @@
  before they can be called from within the main program code.
 ==============================================================================*/
 
+#include    "CONFIG.h"          // Include program feature switches
+
 // PORTA I/O pin definitions
 #define SW1         PORTAbits.RA3   // SW1/PROG/Reset (MCLR) pushbutton input
 #define BEEPER      LATAbits.LATA4  // Piezo beeper (LS1) output
@@ -76,6 +82,39 @@
 #define D5          LATCbits.LATC7  // LED D5 output
 #define LED5        LATCbits.LATC7  // LED D5 output
 
+// Pin descriptor definitions. A pin descriptor is a port letter and bit number
+// pair (e.g. C, 0) that the PIN_xxx() macros convert into the pin's output
+// latch bit, input bit, TRIS bit, or bit mask at compile time. Code written
+// using a descriptor (e.g. #define TRIG_PIN H1_PIN) can be moved to a
+// different pin by changing only the descriptor, and each single-pin access
+// still compiles to one bit instruction (e.g. bsf, bcf or btfss).
+#define H1_PIN      C, 0            // External I/O header H1 (RC0)
+#define H2_PIN      C, 1            // External I/O header H2 (RC1, INT input)
+#define H3_PIN      C, 2            // External I/O header H3 (RC2)
+#define H4_PIN      C, 3            // External I/O header H4 (RC3)
+#define H5_PIN      C, 4            // External I/O header H5 (RC4, LED D2)
+#define H6_PIN      C, 5            // External I/O header H6 (RC5, LED D3)
+#define H7_PIN      C, 6            // External I/O header H7 (RC6, LED D4)
+#define H8_PIN      C, 7            // External I/O header H8 (RC7, LED D5)
+
+#define PIN_LAT(pin)            PIN_LAT_(pin)   // Output latch bit (e.g. LATCbits.LATC0)
+#define PIN_IN(pin)             PIN_IN_(pin)    // Input bit (e.g. PORTCbits.RC0)
+#define PIN_TRIS(pin)           PIN_TRIS_(pin)  // TRIS bit (e.g. TRISCbits.TRISC0)
+#define PIN_BIT(pin)            PIN_BIT_(pin)   // Bit number (e.g. 0)
+#define PIN_MASK(pin)           PIN_MASK_(pin)  // Port register bit mask (e.g. 0b00000001)
+#define PIN_PORT(pin)           PIN_PORT_(pin)  // Port number for #if checks (e.g. PIN_PORT_C)
+
+// Pin descriptor helper macros (the macros above expand the descriptor first)
+#define PIN_LAT_(port, bit)     LAT##port##bits.LAT##port##bit
+#define PIN_IN_(port, bit)      PORT##port##bits.R##port##bit
+#define PIN_TRIS_(port, bit)    TRIS##port##bits.TRIS##port##bit
+#define PIN_BIT_(port, bit)     (bit)
+#define PIN_MASK_(port, bit)    (1 << (bit))
+#define PIN_PORT_(port, bit)    PIN_PORT_##port
+#define PIN_PORT_A              0
+#define PIN_PORT_B              1
+#define PIN_PORT_C              2
+
 // ADC (A-D converter) input channel definitions
 #define AN4         0b00010000      // A-D converter channel 4 input
 #define ANH1        0b00010000      // External H1 header analogue input (Ch4))
@@ -94,9 +133,77 @@
 #define AN11        0b00101100      // A-D converter channel 11 input (SW3)
 #define ANTIM       0b01110100      // On-die temperature indicator module input
 
+// ADC acquisition time definitions. ADC_burst() waits ADC_ACQ_TIME after
+// switching to each channel for the ADC holding capacitor to charge before
+// starting the conversion. 5us is enough for input sources of up to 10k ohms.
+// The temperature indicator (ANTIM) has a high output impedance and needs
+// ADC_TEMP_ACQ_TIME, and is enabled (high range) when a burst selects it, and
+// restored to its previous setting when the burst ends. ADC_burst_start()
+// bursts wait for the same times in ADC_burst_isr(), so a burst that includes
+// ANTIM holds off lower-priority interrupts for ADC_TEMP_ACQ_TIME.
+#define ADC_ACQ_TIME 5              // ADC acquisition time (us)
+#define ADC_TEMP_ACQ_TIME 200       // Temperature indicator acquisition time (us)
+
+// ADC burst variables (written by ADC_burst_isr())
+extern volatile bool adcBurstDone;  // ADC_burst_start() burst complete
+
 // Clock frequency definition for delay macros and simulation
 #define _XTAL_FREQ  48000000        // Set clock frequency for time delays
 
+// Timer1 pulse measurement definitions (timer_config() rate settings). Timer1
+// counts FOSC/4 (12MHz) instruction cycles through its prescaler. At 12MHz, the
+// longest pulse that can be measured is 5.46ms (about 94cm of SONAR range), and
+// at 1.5MHz it is 43.7ms (one 58us SONAR cm is 87 Timer1 ticks).
+#define TIMER_12MHZ 0b00000000      // Timer1 FOSC/4, 1:1 prescaler (1/12us ticks)
+#define TIMER_1_5MHZ 0b00110000     // Timer1 FOSC/4, 1:8 prescaler (2/3us ticks)
+#define TIMER_IN    H2IN            // Pulse input measured by timer_pulse()
+
+// Watchdog timer period definitions (WDTCON settings, including SWDTEN to
+// enable the WDT). Use to set the watchdog reset period, or the sleep_wdt()
+// wake-up period. WDT periods are timed by the 31kHz LFINTOSC and are approximate.
+#define WDT_1MS     0b00000001      // 1ms WDT period
+#define WDT_2MS     0b00000011      // 2ms WDT period
+#define WDT_4MS     0b00000101      // 4ms WDT period
+#define WDT_8MS     0b00000111      // 8ms WDT period
+#define WDT_16MS    0b00001001      // 16ms WDT period
+#define WDT_32MS    0b00001011      // 32ms WDT period
+#define WDT_64MS    0b00001101      // 64ms WDT period
+#define WDT_128MS   0b00001111      // 128ms WDT period
+#define WDT_256MS   0b00010001      // 256ms WDT period
+#define WDT_512MS   0b00010011      // 512ms WDT period
+#define WDT_1S      0b00010101      // 1s WDT period
+
+// Interrupt handler definitions. The interrupt service routine in UBMP420.c
+// checks each enabled interrupt source in the priority order listed below, and
+// calls the handler function defined for each source with a pending interrupt.
+// Define each source's handler function name here (handlers are void functions
+// with no parameters), and comment out sources that are not used to remove
+// them from the interrupt service routine. The dispatcher clears the INT,
+// timer, MSSP and ADC interrupt flags before calling their handlers, while
+// the IOC handler must clear the IOCBF bits and the EUSART handlers must read
+// RCREG or write TXREG. The INT handler runs first, about 1us after its edge,
+// and each source checked before another adds about 4 instruction cycles
+// (0.33us) to that source's worst-case interrupt latency, plus the run-time
+// of any higher-priority handlers that are called first. The optional
+// handlers are only defined when their CONFIG.h feature switch is enabled.
+#define ISR_INT     sonar_echo_isr  // INT pin (SONAR ECHO) edge
+#define ISR_TMR1    sonar_timer_isr // Timer1 overflow (SONAR timeout)
+#define ISR_TMR0    tick_isr        // Timer0 overflow (TASK.c 1ms tick)
+#ifdef PROXIMITY_TONE
+#define ISR_TMR2    tone_isr        // Timer2 period match (TONE.c beeper)
+#endif
+// #define ISR_IOC  button_isr      // PORTB interrupt-on-change (SW2-SW5)
+// #define ISR_RX   rx_isr          // EUSART receive
+#ifdef TELEMETRY
+#define ISR_TX      serial_tx_isr   // EUSART transmit (SERIAL.c telemetry)
+#endif
+#ifdef I2C_SLAVE
+#define ISR_SSP     i2c_isr         // MSSP I2C slave byte (I2C.c register map)
+#endif
+#ifdef ADC_BURST
+#define ISR_ADC     ADC_burst_isr   // ADC conversion complete (ADC burst)
+#endif
+
 // Prototypes for UBMP420.c functions:
 
 /**
@@ -149,5 +256,86 @@ unsigned char ADC_read(void);
  */
 unsigned char ADC_read_channel(unsigned char);
 
+/**
+ * Function: void ADC_burst(const unsigned char *channels, unsigned char *results, unsigned char count)
+ * 
+ * Convert each of the count ADC channels in the channels list (channel
+ * constants defined above), in order, and save the 8-bit conversion results
+ * in the results array. The ADC is kept on between channels, and only waits
+ * the channel's acquisition time (ADC_ACQ_TIME, or ADC_TEMP_ACQ_TIME for
+ * ANTIM) after each channel switch. Call ADC_config() first, and enable
+ * the analog inputs of any other channels used.
+ * 
+ * Example usage: ADC_burst(sensorChannels, sensorLevels, 2);
+ */
+void ADC_burst(const unsigned char *, unsigned char *, unsigned char);
+
+/**
+ * Function: void ADC_burst_start(const unsigned char *channels, unsigned char *results, unsigned char count)
+ * 
+ * Start converting the channels list as in ADC_burst(), and return once the
+ * first channel has settled and its conversion has started. The ADC interrupt
+ * saves each result, then switches to the next channel and starts converting
+ * it after its acquisition time, setting adcBurstDone after the last
+ * conversion (or at once if count is 0). Each channel takes its acquisition
+ * time plus about 15us. Enable ADC_BURST in CONFIG.h to compile the
+ * interrupt-driven burst functions.
+ * 
+ * Example usage: ADC_burst_start(sensorChannels, sensorLevels, 2);
+ */
+void ADC_burst_start(const unsigned char *, unsigned char *, unsigned char);
+
+/**
+ * Function: void ADC_burst_isr(void)
+ * 
+ * ADC interrupt handler for ADC_burst_start(). Called by the interrupt
+ * dispatcher (ISR_ADC).
+ */
+void ADC_burst_isr(void);
+
+/**
+ * Function: void sleep_wdt(unsigned char period)
+ * 
+ * Stop the oscillator and sleep in low-power mode until the WDT period
+ * specified by one of the WDT period constants defined above expires, or an
+ * enabled interrupt (e.g. INT) wakes the microcontroller. Restores the previous
+ * WDT period and waits for the 48 MHz PLL to lock again before returning.
+ * Timer1 (clocked from FOSC/4) and the USB module stop while sleeping.
+ * 
+ * Example usage: sleep_wdt(WDT_64MS);
+ */
+void sleep_wdt(unsigned char);
+
+/**
+ * Function: void timer_config(unsigned char rate)
+ * 
+ * Configure Timer1 to count at the rate specified by one of the Timer1 rate
+ * constants defined above, and clear it. Timer1 is also used by the SONAR.c
+ * interrupt-driven measurement functions, so use one or the other.
+ * 
+ * Example usage: timer_config(TIMER_1_5MHZ);
+ */
+void timer_config(unsigned char);
+
+/**
+ * Function: void timer_clear(void)
+ * 
+ * Stop Timer1, and clear its count and overflow flag.
+ * 
+ * Example usage: timer_clear();
+ */
+void timer_clear(void);
+
+/**
+ * Function: unsigned int timer_pulse(void)
+ * 
+ * Measure the length of the next high pulse on the TIMER_IN pin in Timer1
+ * ticks. Returns 0 if the pulse does not start before Timer1 overflows after
+ * the last timer_clear(), or if the pulse is too long to be measured.
+ * 
+ * Example usage: timerResult = timer_pulse();
+ */
+unsigned int timer_pulse(void);
+
 // TODO - Add additional function prototypes for any new functions added to
 // the UBMP420.c file here.
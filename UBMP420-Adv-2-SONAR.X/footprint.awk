@@ -0,0 +1,142 @@
+# File: footprint.awk
+# Date: October 14, 2026
+#
+# Program and data memory footprint report for the XC8 linker map file.
+#
+# Lists the program memory (words) used by each function, the compiled stack
+# data memory (bytes) used by each function, and the data memory (bytes) used
+# by each data psect, from the map file, then totals the program memory used by
+# the SONAR core (the sonar_* functions in SONAR.c) and exits with an error if
+# the total is larger than the 'budget' variable (words). XC8 places each
+# function in its own psect, so each function's size is the length of the
+# psect holding its symbol. Each function's parameters (?_name), temporaries
+# (??_name) and auto variables (name@variable) are placed in the cstack psects,
+# so each of these symbols' size is the distance to the next higher symbol of
+# the same function (or, for its last symbol, of any function overlaid there,
+# or the end of the psect). Run using 'make footprint', e.g.:
+#
+#   awk -v budget=1024 -f footprint.awk dist/default/production/*.map
+
+# Convert a hexadecimal number to decimal (strtonum() is gawk-only)
+function hex(digits,    i, value)
+{
+    value = 0
+    digits = toupper(digits)
+    for (i = 1; i <= length(digits); i++)
+        value = value * 16 + index("0123456789ABCDEF", substr(digits, i, 1)) - 1
+    return value
+}
+
+# Link map - psect lengths (first table only, before the TOTAL class summary).
+# Lines starting in the first column begin with the object file name.
+/^TOTAL/ { linkMap = 0 }
+/Name +Link +Load +Length +Selector/ { linkMap = 1; next }
+linkMap && NF >= 6 {
+    o = ($0 ~ /^[^ \t]/) ? 1 : 0
+    psect = $(1 + o)
+    size = hex($(4 + o))
+    if ($(6 + o) == "0")
+        codeLength[psect] += size
+    else
+    {
+        dataLength[psect] += size
+        end = hex($(2 + o)) + size
+        if (end > dataEnd[psect])
+            dataEnd[psect] = end
+    }
+    next
+}
+
+# Symbol table - function name, psect and address triples.
+/^Symbol Table/ { symbols = 1; next }
+symbols {
+    for (i = 1; i + 2 <= NF; i += 3)
+    {
+        name = $i
+        if (name ~ /^_[A-Za-z]/ && name !~ /[@$]/ && ($(i + 1) in codeLength))
+            funcPsect[substr(name, 2)] = $(i + 1)
+        else if ($(i + 1) ~ /^cstack/)
+        {
+            owner = name                # ?_name, ??_name or name@variable
+            sub(/^\?+_/, "", owner)
+            sub(/@.*/, "", owner)
+            sub(/^_/, "", owner)
+            stackCount++
+            stackOwner[stackCount] = owner
+            stackPsect[stackCount] = $(i + 1)
+            stackAddress[stackCount] = hex($(i + 2))
+        }
+    }
+}
+
+# Compiled stack symbol size - the distance to the next higher symbol of the
+# same function, or of any function, or to the end of the psect.
+# Symbols sharing an address with an earlier symbol of the same function
+# (e.g. ??_name and its first auto variable) have no size of their own.
+function stack_size(n,    i, own, any, address)
+{
+    address = stackAddress[n]
+    own = any = dataEnd[stackPsect[n]]
+    for (i = 1; i <= stackCount; i++)
+    {
+        if (stackPsect[i] != stackPsect[n])
+            continue
+        if (i < n && stackAddress[i] == address && stackOwner[i] == stackOwner[n])
+            return 0
+        if (stackAddress[i] <= address)
+            continue
+        if (stackAddress[i] < any)
+            any = stackAddress[i]
+        if (stackOwner[i] == stackOwner[n] && stackAddress[i] < own)
+            own = stackAddress[i]
+    }
+    return ((own < dataEnd[stackPsect[n]]) ? own : any) - address
+}
+
+END {
+    if (!symbols)
+    {
+        print "footprint: no symbol table found in " FILENAME > "/dev/stderr"
+        exit 2
+    }
+    sort = "sort -k2 -n -r"
+    print "Program memory (words)"
+    for (name in funcPsect)
+    {
+        size = codeLength[funcPsect[name]]
+        printf("    %-28s %5d\n", name, size) | sort
+        if (name ~ /^sonar_/)
+            sonarWords += size
+    }
+    close(sort)
+    for (psect in codeLength)
+        codeWords += codeLength[psect]
+    printf("    %-28s %5d\n\n", "Total", codeWords)
+
+    print "Compiled stack data memory (bytes, overlaid between functions)"
+    for (n = 1; n <= stackCount; n++)
+        stackBytes[stackOwner[n]] += stack_size(n)
+    for (name in stackBytes)
+        printf("    %-28s %5d\n", name, stackBytes[name]) | sort
+    close(sort)
+    printf("\n")
+
+    print "Data memory (bytes)"
+    for (psect in dataLength)
+    {
+        printf("    %-28s %5d\n", psect, dataLength[psect]) | sort
+        dataBytes += dataLength[psect]
+    }
+    close(sort)
+    printf("    %-28s %5d\n\n", "Total", dataBytes)
+
+    printf("SONAR core (sonar_*) program memory: %d words", sonarWords)
+    if (budget > 0)
+        printf(" (budget %d words)", budget)
+    printf("\n")
+    if (budget > 0 && sonarWords > budget)
+    {
+        print "footprint: SONAR core is over its program memory budget" > "/dev/stderr"
+        exit 1
+    }
+}
@@ -0,0 +1,461 @@
+/*==============================================================================
+ File: HOST.c
+ Date: October 14, 2026
+
+ SONAR host (PC) test harness
+
+ Runs the SONAR.c range functions on a PC against simulated HC-SR04 SONAR
+ modules, using the SONAR_HOST definitions in SONAR.h and the register stub in
+ this directory's xc.h. Build and run it using 'make host-test', which builds
+ it for a single SONAR module, the SONAR_SCAN scanner and SONAR_PARALLEL
+ ranging, and fails if any scenario check fails.
+
+ Time is counted in instruction cycles (FOSC/4). Every sonar_host_delay()
+ cycle, the harness steps the simulated hardware: it starts each module's
+ ECHO waveform when its TRIG pin falls, updates the ECHO inputs in PORTC,
+ counts Timer1 at 1:8 into TMR1H and TMR1L, sets INTF on the INTEDG edge of
+ the INT (ECHO) pin and TMR1IF on Timer1 overflow, and calls the interrupt
+ handlers in the same order as the UBMP420.c interrupt dispatcher when GIE is
+ set. Interrupt latency and the handlers' own cycles are not modelled.
+
+ Each module produces one ECHO pulse per ping, starting HOST_ECHO_DELAY after
+ its TRIG pulse ends, and ignores TRIG until its ECHO pulse ends. Crosstalk
+ is modelled by a reverberation time: a module pinged less than hostReverb
+ after another module's ping hears that ping's stray echo instead of its own,
+ and reports a phantom target at HOST_STRAY_RANGE.
+==============================================================================*/
+
+#define     HOST_REGISTERS      // Define the register variables declared in xc.h
+#include    "xc.h"              // Host register stub (this directory)
+#include    <stdio.h>           // Include standard I/O for the results
+
+#include    "UBMP420.h"         // Include UBMP4.2 constant & function definitions
+#include    "SONAR.h"           // Include SONAR constant & function definitions
+
+// Host time definitions
+#define HOST_CYCLES_PER_US  (_XTAL_FREQ / 4000000)  // Instruction cycles per us
+#define HOST_US(time)       ((unsigned long)(time) * HOST_CYCLES_PER_US)
+#define HOST_MS(time)       HOST_US((unsigned long)(time) * 1000)
+#define HOST_CM(range)      ((unsigned long)(range) * SONAR_CM_TIME * HOST_CYCLES_PER_US / 10)
+#define HOST_NEVER          0xFFFFFFFFUL    // ECHO never starts (or never ends)
+
+// Simulated SONAR module definitions
+#define HOST_MODULES        3           // Simulated SONAR modules
+#define HOST_ECHO_DELAY     HOST_US(450)    // TRIG end to ECHO start (cycles)
+#define HOST_STRAY_RANGE    10          // Crosstalk phantom target range (cm)
+
+// Simulated SONAR module TRIG and ECHO pins. Parallel modules each have their
+// own ECHO pin, and the other modules' ECHO outputs are diode-ORed onto H2.
+const unsigned char hostTrigPins[HOST_MODULES] = {SONAR1_TRIG, SONAR2_TRIG, SONAR3_TRIG};
+#ifdef SONAR_PARALLEL
+const unsigned char hostEchoPins[HOST_MODULES] = {SONAR1_ECHO, SONAR2_ECHO, SONAR3_ECHO};
+#else
+const unsigned char hostEchoPins[HOST_MODULES] = {SONAR1_ECHO, SONAR1_ECHO, SONAR1_ECHO};
+#endif
+
+// Simulated hardware variables
+unsigned char sonarHostTrig = 0;    // TRIG output (sonar_count() TRIG pulses)
+unsigned long hostTime = 0;     // Simulated time (cycles)
+unsigned char hostPrescale = 0; // Timer1 prescaler count
+unsigned char hostTrigs = 0;    // TRIG pin levels at the last step
+bool hostEcho = false;          // INT pin level at the last step
+bool hostInterrupt = false;     // Interrupt handler running
+
+// Simulated SONAR module variables
+unsigned long hostEchoLength[HOST_MODULES]; // ECHO pulse length (cycles, or HOST_NEVER)
+unsigned long hostEchoStart[HOST_MODULES];  // ECHO start time of last ping (or HOST_NEVER)
+unsigned long hostEchoEnd[HOST_MODULES];    // ECHO end time of last ping (or HOST_NEVER)
+unsigned long hostPingTime = HOST_NEVER;    // Time of the last ping of any module
+unsigned char hostPingModule;   // Module pinged last
+unsigned long hostReverb = 0;   // Crosstalk reverberation time (cycles)
+unsigned char hostPings[HOST_MODULES];  // Pings of each module
+
+// Scenario check variables
+const char *hostScenario;       // Name of the running scenario
+unsigned int hostChecks = 0;    // Checks made
+unsigned int hostFailures = 0;  // Checks failed
+
+// Check a scenario result, and report it if it fails.
+void host_check(bool pass, const char *check, long value)
+{
+    hostChecks ++;
+    if(!pass)
+    {
+        hostFailures ++;
+        printf("FAIL %s: %s (%ld)\n", hostScenario, check, value);
+    }
+}
+
+// Return the ECHO output of a module at the current time.
+bool host_module_echo(unsigned char module)
+{
+    return(hostEchoStart[module] != HOST_NEVER && hostTime >= hostEchoStart[module]
+        && hostTime < hostEchoEnd[module]);
+}
+
+// Return the ECHO output bits of all modules (SONAR_ECHO_PINS bits of PORTC).
+unsigned char sonar_host_echoes(void)
+{
+    unsigned char echoes = 0;
+    for(unsigned char i = 0; i != HOST_MODULES; i++)
+    {
+        if(host_module_echo(i))
+        {
+            echoes = echoes | hostEchoPins[i];
+        }
+    }
+    return(echoes);
+}
+
+// Return the ECHO (INT) pin level.
+unsigned char sonar_host_echo(void)
+{
+    return((sonar_host_echoes() & SONAR1_ECHO) ? 1 : 0);
+}
+
+// Start a module's ECHO pulse when its TRIG pulse ends. A module ignores TRIG
+// until its last ECHO pulse ends, and hears the stray echo of another module
+// pinged less than hostReverb earlier at HOST_STRAY_RANGE.
+void host_ping(unsigned char module)
+{
+    if(hostEchoStart[module] != HOST_NEVER && hostTime < hostEchoEnd[module])
+    {
+        return;                 // Module busy
+    }
+    hostPings[module] ++;
+    hostEchoStart[module] = HOST_NEVER;
+    if(hostEchoLength[module] != 0)
+    {
+        hostEchoStart[module] = hostTime + HOST_ECHO_DELAY;
+        hostEchoEnd[module] = HOST_NEVER;
+        if(hostEchoLength[module] != HOST_NEVER)
+        {
+            hostEchoEnd[module] = hostEchoStart[module] + hostEchoLength[module];
+        }
+        if(hostPingTime != HOST_NEVER && hostPingModule != module
+            && hostTime - hostPingTime < hostReverb)
+        {
+            hostEchoEnd[module] = hostEchoStart[module] + HOST_CM(HOST_STRAY_RANGE);
+        }
+    }
+    hostPingTime = hostTime;
+    hostPingModule = module;
+}
+
+// Step the simulated hardware by one instruction cycle.
+void host_step(void)
+{
+    hostTime ++;
+
+    // Start the ECHO waveform of each module whose TRIG pin has fallen
+    unsigned char trigs = (LATC & SONAR_TRIG_PINS) | (sonarHostTrig ? SONAR1_TRIG : 0);
+    for(unsigned char i = 0; i != HOST_MODULES; i++)
+    {
+        if((hostTrigs & hostTrigPins[i]) && !(trigs & hostTrigPins[i]))
+        {
+            host_ping(i);
+        }
+    }
+    hostTrigs = trigs;
+    PORTC = (PORTC & ~SONAR_ECHO_PINS) | sonar_host_echoes();
+
+    // Count Timer1 (FOSC/4, 1:8 prescaler), setting TMR1IF on overflow
+    if(TMR1ON)
+    {
+        hostPrescale ++;
+        if(hostPrescale == 8)
+        {
+            hostPrescale = 0;
+            uint16_t count = (uint16_t)(TMR1 + 1);
+            if(count == 0)
+            {
+                TMR1IF = 1;
+            }
+            TMR1H = (unsigned char)(count >> 8);
+            TMR1L = (unsigned char)count;
+        }
+    }
+
+    // Set INTF on the INTEDG edge of the INT pin
+    bool echo = sonar_host_echo();
+    if(echo != hostEcho && echo == INTEDG)
+    {
+        INTF = 1;
+    }
+    hostEcho = echo;
+
+    // Run the interrupt handlers, as the UBMP420.c interrupt dispatcher does
+    if(GIE && !hostInterrupt)
+    {
+        hostInterrupt = true;
+        if(INTE && INTF)
+        {
+            INTF = 0;
+            sonar_echo_isr();
+        }
+        if(TMR1IE && TMR1IF && PEIE)
+        {
+            TMR1IF = 0;
+            sonar_timer_isr();
+        }
+        hostInterrupt = false;
+    }
+}
+
+// Delay for the specified number of instruction cycles (SONAR_DELAY()).
+void sonar_host_delay(unsigned long cycles)
+{
+    while(cycles != 0)
+    {
+        host_step();
+        cycles --;
+    }
+}
+
+// Run the simulated hardware until flag is set, or for at most cycles. Returns
+// true if flag was set.
+bool host_wait(volatile bool *flag, unsigned long cycles)
+{
+    while(!*flag && cycles != 0)
+    {
+        host_step();
+        cycles --;
+    }
+    return(*flag);
+}
+
+// Set the ECHO pulse length of a module (HOST_NEVER for an ECHO pulse that
+// never ends, or 0 for a missing module).
+void host_module(unsigned char module, unsigned long length)
+{
+    hostEchoLength[module] = length;
+}
+
+// Start a new scenario with idle modules and a ready SONAR module.
+void host_scenario(const char *name)
+{
+    hostScenario = name;
+    for(unsigned char i = 0; i != HOST_MODULES; i++)
+    {
+        hostEchoLength[i] = 0;
+        hostEchoStart[i] = HOST_NEVER;
+        hostPings[i] = 0;
+    }
+    hostPingTime = HOST_NEVER;
+    hostReverb = 0;
+    sonar_cancel();
+    sonar_max_range(SONAR_MAX_RANGE);
+    sonarDone = false;
+    sonar_host_delay(HOST_MS(SONAR_RECOVERY_TIME + 1));
+}
+
+// Blocking range scenarios - sonar_range_cm() ranges, ECHO start timeout,
+// maximum range, blanking window and ECHO still active from the last ping.
+void host_range_scenarios(void)
+{
+    const unsigned char ranges[] = {5, 25, 100, 200, 254};
+    host_scenario("range_cm");
+    for(unsigned char i = 0; i != sizeof(ranges); i++)
+    {
+        host_module(0, HOST_CM(ranges[i]));
+        unsigned char range = sonar_range_cm();
+        host_check(range == ranges[i], "range", range);
+        host_check(sonarStatus == SONAR_OK, "status", sonarStatus);
+        sonar_host_delay(HOST_MS(SONAR_RECOVERY_TIME));
+    }
+
+    host_scenario("range_cm timeout");
+    unsigned long start = hostTime;
+    host_check(sonar_range_cm() == 0, "range", 0);
+    host_check(sonarStatus == SONAR_NO_SENSOR, "status", sonarStatus);
+    unsigned long time = hostTime - start;
+    host_check(time > HOST_US(SONAR_START_TIMEOUT) && time < HOST_US(SONAR_START_TIMEOUT + 40), "timeout (cycles)", (long)time);
+
+    host_scenario("range_cm max range");
+    host_module(0, HOST_CM(300));
+    start = hostTime;
+    host_check(sonar_range_cm() == 0, "range", 0);
+    host_check(sonarStatus == SONAR_NO_ECHO, "status", sonarStatus);
+    time = hostTime - start - HOST_US(20) - HOST_ECHO_DELAY;
+    host_check(time > HOST_CM(SONAR_MAX_RANGE - 1) && time < HOST_CM(SONAR_MAX_RANGE + 1), "counting time (cycles)", (long)time);
+
+    host_scenario("range_cm blanked");
+    host_module(0, HOST_CM(1));
+    host_check(sonar_range_cm() == 0, "range", 0);
+    host_check(sonarStatus == SONAR_BLANKED, "status", sonarStatus);
+
+    host_scenario("range_cm not ready");
+    host_module(0, HOST_NEVER);
+    sonar_range_cm();
+    host_check(sonarStatus == SONAR_NO_ECHO, "first status", sonarStatus);
+    host_check(sonar_range_cm() == 0, "range", 0);
+    host_check(sonarStatus == SONAR_NOT_READY, "second status", sonarStatus);
+}
+
+// Interrupt-driven scenarios - sonar_start() ranges, ECHO start timeout,
+// maximum range, beyond-range ECHO drain, and sonar_cancel() of an ECHO pulse
+// that never ends.
+void host_interrupt_scenarios(void)
+{
+    const unsigned char ranges[] = {5, 25, 100, 200, 254};
+    host_scenario("interrupt");
+    for(unsigned char i = 0; i != sizeof(ranges); i++)
+    {
+        host_module(0, HOST_CM(ranges[i]));
+        host_check(sonar_ready(), "ready", 0);
+        sonar_start();
+        host_check(host_wait(&sonarDone, HOST_MS(40)), "done", i);
+        unsigned char range = sonar_read();
+        host_check(range == ranges[i], "range", range);
+        host_check(sonarStatus == SONAR_OK, "status", sonarStatus);
+        host_check(!sonarBusy, "busy", sonarBusy);
+        sonar_host_delay(HOST_MS(SONAR_RECOVERY_TIME + 1));
+    }
+
+    host_scenario("interrupt timeout");
+    unsigned long start = hostTime;
+    sonar_start();
+    host_check(host_wait(&sonarDone, HOST_MS(40)), "done", 0);
+    unsigned long time = hostTime - start;
+    host_check(time > HOST_US(SONAR_START_TIMEOUT - 20) && time < HOST_US(SONAR_START_TIMEOUT + 20), "timeout (cycles)", (long)time);
+    host_check(sonarStatus == SONAR_NO_SENSOR, "status", sonarStatus);
+    host_check(sonar_read() == 0, "range", 0);
+    host_check(!sonarBusy, "busy", sonarBusy);
+
+    host_scenario("interrupt max range");
+    sonar_max_range(100);
+    host_module(0, HOST_CM(150));
+    sonar_start();
+    host_check(host_wait(&sonarDone, HOST_MS(40)), "done", 0);
+    time = hostTime - hostEchoStart[0];
+    host_check(time > HOST_CM(99) && time < HOST_CM(101), "counting time (cycles)", (long)time);
+    host_check(sonarStatus == SONAR_NO_ECHO, "status", sonarStatus);
+    host_check(sonar_read() == 0, "range", 0);
+
+    host_scenario("interrupt drain");
+    host_module(0, HOST_CM(400));
+    sonar_start();
+    host_check(host_wait(&sonarDone, HOST_MS(40)), "done", 0);
+    host_check(sonarStatus == SONAR_NO_ECHO, "status", sonarStatus);
+    host_check(sonarBusy && sonarDraining, "draining", sonarDraining);
+    sonar_read();
+    while(hostTime < hostEchoEnd[0] - 1)
+    {
+        host_check(!sonar_ready() && !sonarDone, "ready while draining", (long)hostTime);
+        sonar_host_delay(HOST_MS(1));
+    }
+    sonar_host_delay(HOST_US(10));
+    host_check(!sonarBusy && !sonarDraining, "drained", sonarBusy);
+    host_check(!sonarDone, "drain result", sonarDone);
+    host_check(!sonar_ready(), "ready while recovering", 0);
+    sonar_host_delay(HOST_MS(SONAR_RECOVERY_TIME));
+    host_check(sonar_ready(), "ready after recovery", 0);
+
+    host_scenario("interrupt drain cancel");
+    host_module(0, HOST_NEVER);
+    sonar_start();
+    host_check(host_wait(&sonarDone, HOST_MS(40)), "done", 0);
+    sonar_read();
+    sonar_host_delay(HOST_MS(30));
+    host_check(sonarBusy, "busy", sonarBusy);
+    sonar_cancel();
+    host_check(!sonarBusy && !sonarDraining && !INTE && !TMR1IE, "cancelled", sonarBusy);
+    host_check(!sonar_ready(), "ready with ECHO high", 0);
+    hostEchoEnd[0] = hostTime;  // Release the stuck ECHO pulse
+    sonar_host_delay(HOST_MS(SONAR_RECOVERY_TIME + 1));
+    host_check(sonar_ready(), "ready after ECHO ends", 0);
+}
+
+#ifdef SONAR_SCAN
+// Scanner crosstalk scenario - modules pinged in turn must each report their
+// own range, although every ping leaves stray echoes for 20ms (less than
+// SONAR_GUARD_TIME), since the next module is only pinged after the guard time.
+void host_scan_scenarios(void)
+{
+    const unsigned char ranges[SONAR_SENSORS] = {50, 120, 80};
+    host_scenario("scan crosstalk");
+    hostReverb = HOST_MS(20);
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        host_module(i, HOST_CM(ranges[i]));
+    }
+    sonarUpdated = 0;
+    for(unsigned int ms = 0; ms != 300; ms++)
+    {
+        sonar_scan();
+        sonar_host_delay(HOST_MS(1));
+    }
+    host_check(sonarUpdated == (1 << SONAR_SENSORS) - 1, "updated", sonarUpdated);
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        host_check(sonarRanges[i] == ranges[i], "range", sonarRanges[i]);
+        host_check(hostPings[i] >= 2, "pings", hostPings[i]);
+    }
+}
+#endif
+
+#ifdef SONAR_PARALLEL
+// Parallel ranging scenarios - every module's range counted in one pass, a
+// missing module, a module beyond maximum range, and no modules at all.
+void host_parallel_scenarios(void)
+{
+    const unsigned char ranges[SONAR_SENSORS] = {30, 90, 150};
+    host_scenario("parallel");
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        host_module(i, HOST_CM(ranges[i]));
+    }
+    sonar_range_parallel();
+    host_check(sonarStatus == SONAR_OK, "status", sonarStatus);
+    for(unsigned char i = 0; i != SONAR_SENSORS; i++)
+    {
+        host_check(sonarRanges[i] == ranges[i], "range", sonarRanges[i]);
+    }
+
+    host_scenario("parallel timeout");
+    host_module(0, HOST_CM(30));
+    host_module(1, HOST_CM(90));
+    sonar_range_parallel();
+    host_check(sonarStatus == SONAR_NO_ECHO, "status", sonarStatus);
+    host_check(sonarRanges[0] == 30 && sonarRanges[1] == 90, "ranges", sonarRanges[1]);
+    host_check(sonarRanges[2] == 0, "missing range", sonarRanges[2]);
+
+    host_scenario("parallel max range");
+    host_module(0, HOST_CM(30));
+    host_module(1, HOST_CM(300));
+    host_module(2, HOST_CM(150));
+    unsigned long start = hostTime;
+    sonar_range_parallel();
+    unsigned long time = hostTime - start - HOST_US(20) - HOST_ECHO_DELAY;
+    host_check(time > HOST_CM(SONAR_MAX_RANGE - 1) && time < HOST_CM(SONAR_MAX_RANGE + 1), "counting time (cycles)", (long)time);
+    host_check(sonarStatus == SONAR_NO_ECHO, "status", sonarStatus);
+    host_check(sonarRanges[0] == 30 && sonarRanges[2] == 150, "ranges", sonarRanges[2]);
+    host_check(sonarRanges[1] == 0, "beyond range", sonarRanges[1]);
+    time = (hostTime - start) / 8;
+    host_check(sonarBlockedTicks + 2 > time && sonarBlockedTicks < time + 2, "blocked time (Timer1 ticks)", sonarBlockedTicks);
+
+    host_scenario("parallel no modules");
+    start = hostTime;
+    sonar_range_parallel();
+    time = hostTime - start;
+    host_check(sonarStatus == SONAR_NO_SENSOR, "status", sonarStatus);
+    host_check(time > HOST_US(SONAR_START_TIMEOUT) && time < HOST_US(SONAR_START_TIMEOUT + 40), "timeout (cycles)", (long)time);
+}
+#endif
+
+int main(void)
+{
+    sonar_config();             // Configure TRIG, Timer1 and ECHO interrupt
+
+    host_range_scenarios();
+    host_interrupt_scenarios();
+#ifdef SONAR_SCAN
+    host_scan_scenarios();
+#endif
+#ifdef SONAR_PARALLEL
+    host_parallel_scenarios();
+#endif
+
+    printf("%u checks, %u failed\n", hostChecks, hostFailures);
+    return((hostFailures == 0) ? 0 : 1);
+}
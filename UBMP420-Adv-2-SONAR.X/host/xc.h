@@ -0,0 +1,66 @@
+/*==============================================================================
+ File: xc.h
+ Date: October 14, 2026
+
+ Host (PC) register stub for SONAR_HOST builds
+
+ Replaces the XC8 compiler's xc.h in host builds of SONAR.c (see 'make
+ host-test'), which add this directory to the include path. Each PIC16F1459
+ register and register bit used by SONAR.c is declared as an ordinary host
+ variable, so the SONAR functions compile unchanged and read and write the
+ simulated registers. HOST.c defines the variables (by defining HOST_REGISTERS
+ before including this file), and models Timer1, the INT pin and the ECHO
+ waveforms using them. Only the registers used by SONAR.c are declared.
+==============================================================================*/
+
+#include    <stdint.h>          // Include integer definitions
+#include    <stdbool.h>         // Include Boolean (true/false) definitions
+
+// Register declarations (or definitions, in HOST.c)
+#ifdef HOST_REGISTERS
+#define HOST_SFR(type, name)    volatile type name
+#else
+#define HOST_SFR(type, name)    extern volatile type name
+#endif
+
+// XC8 compiler extensions used by SONAR.c
+#define __at(address)           // Absolute addresses are ignored on the host
+typedef uint32_t uint24_t;      // XC8 24-bit integer
+
+// PORTC registers (SONAR header pins)
+typedef struct {
+    unsigned TRISC0:1; unsigned TRISC1:1; unsigned TRISC2:1; unsigned TRISC3:1;
+    unsigned TRISC4:1; unsigned TRISC5:1; unsigned TRISC6:1; unsigned TRISC7:1;
+} TRISCbits_t;
+HOST_SFR(unsigned char, PORTC); // Port C input levels (set by HOST.c)
+HOST_SFR(unsigned char, LATC);  // Port C output latch (TRIG pins)
+HOST_SFR(unsigned char, TRISC); // Port C direction
+HOST_SFR(TRISCbits_t, TRISCbits);   // Port C direction bits
+
+// Timer1 registers. TMR1 reads the 16-bit count from TMR1H and TMR1L.
+HOST_SFR(unsigned char, T1CON); // Timer1 control
+HOST_SFR(unsigned char, T1GCON);    // Timer1 gate control
+HOST_SFR(unsigned char, TMR1H); // Timer1 count high byte
+HOST_SFR(unsigned char, TMR1L); // Timer1 count low byte
+HOST_SFR(bool, TMR1ON);         // Timer1 on (T1CON bit 0)
+#define TMR1    ((unsigned int)((TMR1H << 8) | TMR1L))
+
+// Interrupt control registers
+HOST_SFR(bool, GIE);            // Global interrupt enable
+HOST_SFR(bool, PEIE);           // Peripheral interrupt enable
+HOST_SFR(bool, INTE);           // INT pin interrupt enable
+HOST_SFR(bool, INTF);           // INT pin interrupt flag
+HOST_SFR(bool, INTEDG);         // INT pin edge (1 = rising)
+HOST_SFR(bool, TMR1IE);         // Timer1 overflow interrupt enable
+HOST_SFR(bool, TMR1IF);         // Timer1 overflow interrupt flag
+
+// ADC and FVR registers (SONAR_TEMP_COMP)
+HOST_SFR(unsigned char, FVRCON);    // Fixed voltage reference control
+HOST_SFR(unsigned char, ADCON0);    // ADC control 0
+HOST_SFR(unsigned char, ADCON1);    // ADC control 1
+HOST_SFR(unsigned char, ADCON2);    // ADC control 2
+HOST_SFR(unsigned char, ADRESH);    // ADC result high byte
+HOST_SFR(unsigned char, ADRESL);    // ADC result low byte
+HOST_SFR(bool, ADON);           // ADC on
+HOST_SFR(bool, GO);             // ADC conversion start/busy
+HOST_SFR(bool, ADIE);           // ADC interrupt enable
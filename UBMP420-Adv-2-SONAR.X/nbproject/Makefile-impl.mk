@@ -31,7 +31,7 @@ DEFAULTCONF=default
 CONF=${DEFAULTCONF}
 
 # All Configurations
-ALLCONFS=default 
+ALLCONFS=default Benchmark Instrumented Minimal 
 
 
 # build
@@ -46,12 +46,18 @@ ALLCONFS=default
 # clobber
 .clobber-impl: .clobber-pre .depcheck-impl
 	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=default clean
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Minimal clean
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Instrumented clean
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Benchmark clean
 
 
 
 # all
 .all-impl: .all-pre .depcheck-impl
 	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=default build
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Minimal build
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Instrumented build
+	    ${MAKE} SUBPROJECTS=${SUBPROJECTS} CONF=Benchmark build
 
 
 
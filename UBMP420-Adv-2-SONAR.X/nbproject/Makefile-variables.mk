@@ -8,3 +8,15 @@ CND_BASEDIR=`pwd`
 CND_ARTIFACT_DIR_default=dist/default/production
 CND_ARTIFACT_NAME_default=UBMP420-Adv-2-SONAR.X.production.hex
 CND_ARTIFACT_PATH_default=dist/default/production/UBMP420-Adv-2-SONAR.X.production.hex
+# Benchmark configuration
+CND_ARTIFACT_DIR_Benchmark=dist/Benchmark/production
+CND_ARTIFACT_NAME_Benchmark=UBMP420-Adv-2-SONAR.X.production.hex
+CND_ARTIFACT_PATH_Benchmark=dist/Benchmark/production/UBMP420-Adv-2-SONAR.X.production.hex
+# Instrumented configuration
+CND_ARTIFACT_DIR_Instrumented=dist/Instrumented/production
+CND_ARTIFACT_NAME_Instrumented=UBMP420-Adv-2-SONAR.X.production.hex
+CND_ARTIFACT_PATH_Instrumented=dist/Instrumented/production/UBMP420-Adv-2-SONAR.X.production.hex
+# Minimal configuration
+CND_ARTIFACT_DIR_Minimal=dist/Minimal/production
+CND_ARTIFACT_NAME_Minimal=UBMP420-Adv-2-SONAR.X.production.hex
+CND_ARTIFACT_PATH_Minimal=dist/Minimal/production/UBMP420-Adv-2-SONAR.X.production.hex